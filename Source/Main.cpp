@@ -2,6 +2,12 @@
 
 #include "StringAxiom.h"
 #include "ThreadedAnalyzer.h"
+#include "StreamingFileAnalyzer.h"
+#include "MappedAudioFile.h"
+#include "AudioFileInput.h"
+#include "BatchAnalyzer.h"
+#include "AnalysisResultFile.h"
+#include "Benchmarks.h"
 #include "Settings.h"
 #include "juce_utils.h"
 
@@ -16,41 +22,6 @@ struct StdoutLogger final : Logger
     }
 };
 
-struct AudioFileInfo {
-    int64 numSamples;   // all we need for now
-    double sampleRate;
-    unsigned int bitDepth;
-};
-
-AudioFileInfo readIntoBuffer(AudioSampleBuffer &buff, const juce::File &file) {
-
-    AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-    const auto reader = std::unique_ptr<AudioFormatReader>( formatManager.createReaderFor(file));
-    if (reader == nullptr) {
-        DBG("Failed to open file " + file.getFileName());
-        return {};
-    }
-
-
-    const auto numSamps = reader->lengthInSamples;
-    if (constexpr auto maxLength = std::numeric_limits<int>::max();
-        numSamps > maxLength)
-    {
-        DBG("Number of samples is greater than the maximum allowed length (" + juce::String{numSamps} + " samples)");
-        return {};
-    }
-    buff.setSize(1, static_cast<int>(numSamps));
-    jassert (static_cast<int>(numSamps) <= buff.getNumSamples());
-    reader->read(&buff, 0, static_cast<int>(numSamps), 0, true, true);
-
-    return {
-        .numSamples = numSamps,
-        .sampleRate = reader->sampleRate,
-        .bitDepth = reader->bitsPerSample
-    };
-}
-
 int main (const int argc, char* argv[])
 {
     juce::ScopedJuceInitialiser_GUI juceInit;
@@ -80,7 +51,8 @@ int main (const int argc, char* argv[])
         return settingsParentTree;
     };
 
-    auto runAnalyzer = [print] (const std::span<const float> &channel, const String &fileName, auto &settingsTree) -> bool
+    auto runAnalyzer = [print] (nvs::analysis::vecReal &&channel, const String &fileName, auto &settingsTree,
+                                const File &outputFile, const bool useCache) -> bool
     {
         if (!nvs::analysis::verifySettingsStructure(settingsTree)) {
             DBG("Settings structure verification failed");
@@ -88,7 +60,10 @@ int main (const int argc, char* argv[])
         }
 
         nvs::analysis::ThreadedAnalyzer analyzer;
-        analyzer.updateStoredAudio(channel, fileName);
+        if (useCache) {
+            analyzer.setCache(nvs::analysis::AnalysisCache::getDefault());
+        }
+        analyzer.updateStoredAudio(std::move(channel), fileName);
         analyzer.updateSettings(settingsTree, true);
         if (!analyzer.startThread(Thread::Priority::normal)) {
             DBG("Failed to start analysis thread\n");
@@ -96,9 +71,27 @@ int main (const int argc, char* argv[])
         }
 
         print("Analysis thread begun...");
-        while (analyzer.isThreadRunning())
-            Thread::sleep(100);
+        analyzer.waitForThreadToExit(-1);
+
+        if (outputFile != File{}) {
+            const auto onsets = analyzer.shareOnsetAnalysis();
+            const auto timbre = analyzer.stealTimbreSpaceRepresentation();
+            if (onsets == nullptr || !timbre.has_value()
+                || !nvs::analysis::AnalysisResultFile::write(outputFile, *onsets, *timbre, analyzer.getSettingsHash(),
+                                                             analyzer.getAnalyzer().getAnalyzedFileSampleRate()))
+            {
+                print("Error: could not write results to " + outputFile.getFullPathName());
+                return false;
+            }
+            print("Results written to " + outputFile.getFullPathName());
+        }
 
+        if (const auto cache = analyzer.getCache()) {
+            const auto stats = cache->getStats();
+            print("Analysis cache (" + cache->getDirectory().getFullPathName() + "): "
+                  + String(stats.hits) + " hits, " + String(stats.misses) + " misses, "
+                  + File::descriptionOfSizeInBytes(stats.bytesSaved) + " served from cache");
+        }
         return true;
     };
 
@@ -114,18 +107,17 @@ int main (const int argc, char* argv[])
         const auto fileName = inputFile.getFileName();
         print("Opening " + fileName + "...");
 
-        AudioSampleBuffer buffer;
-        const auto [numSamples, sampleRate, bitDepth] = readIntoBuffer(buffer, inputFile);
-
-        const auto rp = buffer.getReadPointer(0);
-        const std::span channel0(rp, numSamples);
+        nvs::analysis::vecReal channel0;
+        const auto [numSamples, sampleRate, bitDepth] = nvs::analysis::readIntoWave(channel0, inputFile);
 
         auto settingsParentTree = makeSettingsParentTree(sampleRate, inputFile.getFullPathName());
         auto treeStr = nvs::util::valueTreeToXmlStringSafe(settingsParentTree);
         print(treeStr);
 
         auto settingsTree = settingsParentTree.getChildWithName(nvs::axiom::tsn::Settings);
-        if (!runAnalyzer(channel0, fileName, settingsTree)) {
+        const String outputOption = args.getValueForOption("--output");
+        const File outputFile = outputOption.isNotEmpty() ? File::getCurrentWorkingDirectory().getChildFile(outputOption) : File{};
+        if (!runAnalyzer(std::move(channel0), fileName, settingsTree, outputFile, args.containsOption("--cache"))) {
             jassertfalse;
             return;
         }
@@ -133,18 +125,222 @@ int main (const int argc, char* argv[])
         print("Analysis complete!");
     };
 
+    auto benchmarkProgram = [print, &getInputFile, &makeSettingsParentTree](const ArgumentList &args) -> void
+    {
+        const File inputFile = getInputFile(args);
+        if (inputFile == juce::File{}) {
+            print("Error: Please specify an input file");
+            return;
+        }
+        const String benchmarkName = args.size() > 2 ? args[2].text : String{};
+
+        nvs::analysis::vecReal wave;
+        const auto [numSamples, sampleRate, bitDepth] = nvs::analysis::readIntoWave(wave, inputFile);
+        if (numSamples == 0) {
+            print("Error: could not read " + inputFile.getFileName());
+            return;
+        }
+
+        auto settingsParentTree = makeSettingsParentTree(sampleRate, inputFile.getFullPathName());
+        auto settingsTree = settingsParentTree.getChildWithName(nvs::axiom::tsn::Settings);
+
+        nvs::analysis::Analyzer analyzer;
+        if (!analyzer.updateSettings(settingsTree, true)) {
+            print("Error: invalid settings");
+            return;
+        }
+        if (!nvs::analysis::benchmark::runBenchmarks(benchmarkName, analyzer, wave)) {
+            print("Error: unknown benchmark " + benchmarkName + ". Available:");
+            for (auto const &[name, _] : nvs::analysis::benchmark::getBenchmarks()) {
+                print("\t" + name);
+            }
+        }
+    };
+
+    auto streamingAnalysisProgram = [print, &getInputFile, &makeSettingsParentTree](const ArgumentList &args) -> void
+    {
+        const File inputFile = getInputFile(args);
+        if (inputFile == juce::File{}) {
+            print("Error: Please specify an input file");
+            return;
+        }
+        // uncompressed files are read through a memory mapping, and mono float ones analyzed in place
+        const auto mapped = nvs::analysis::MappedAudioFile::open(inputFile);
+        const auto openedReader = mapped == nullptr ? nvs::analysis::createAudioFileReader(inputFile) : nullptr;
+        AudioFormatReader *reader = mapped != nullptr ? &mapped->getReader() : openedReader.get();
+        if (reader == nullptr) {
+            print("Error: could not read " + inputFile.getFileName());
+            return;
+        }
+
+        auto settingsParentTree = makeSettingsParentTree(reader->sampleRate, inputFile.getFullPathName());
+        auto settingsTree = settingsParentTree.getChildWithName(nvs::axiom::tsn::Settings);
+        nvs::analysis::Analyzer analyzer;
+        if (!analyzer.updateSettings(settingsTree, true)) {
+            print("Error: invalid settings");
+            return;
+        }
+
+        const String windowOption = args.getValueForOption("--window");
+        const double windowSeconds = windowOption.isNotEmpty() ? windowOption.getDoubleValue() : 4.0;
+        const auto windowSizeInSamples = static_cast<int>(std::clamp(windowSeconds * reader->sampleRate,
+                                                                     1024.0, static_cast<double>(1 << 28)));
+
+        const String outputOption = args.getValueForOption("--output");
+        const File outputFile = outputOption.isNotEmpty() ? File::getCurrentWorkingDirectory().getChildFile(outputOption) : File{};
+        // only gathered when they are to be written; otherwise each event is dropped once counted
+        std::vector<juce::int64> onsetSamples;
+        std::vector<nvs::analysis::FeatureContainer<nvs::analysis::EventwiseStatistics<nvs::analysis::Real>>> measurements;
+        nvs::analysis::LiveAnalyzer::EventCallback onEvent;
+        if (outputFile != File{}) {
+            onEvent = [&](nvs::analysis::LiveAnalyzer::Event const &event) {
+                onsetSamples.push_back(event.startSample);
+                measurements.push_back(event.features);
+            };
+        }
+
+        print("Streaming " + inputFile.getFileName() + " (" + String(reader->lengthInSamples) + " samples) through a "
+              + String(windowSizeInSamples) + " sample window...");
+        const auto neverExit = [] { return false; };
+        const auto stats = mapped != nullptr && !mapped->getFloatSamples().empty()
+            ? nvs::analysis::analyzeSamplesStreaming(mapped->getFloatSamples(), analyzer.getSettings(), onEvent,
+                                                     windowSizeInSamples, neverExit)
+            : nvs::analysis::analyzeFileStreaming(*reader, analyzer.getSettings(), onEvent, windowSizeInSamples, neverExit);
+        if (!stats.has_value()) {
+            print("Error: streaming analysis failed");
+            return;
+        }
+        print("Streaming analysis complete: " + String(stats->numEvents) + " events in " + String(stats->seconds, 2)
+              + " s, first after " + String(stats->secondsToFirstEvent, 3) + " s");
+
+        if (outputFile != File{}) {
+            // normalized to the decoded length, as --analyze writes them. the decoded wave is never held whole, so the
+            // audio hash is of the file itself
+            std::vector<float> onsets;
+            onsets.reserve(onsetSamples.size());
+            for (const auto start : onsetSamples) {
+                onsets.push_back(static_cast<float>(static_cast<double>(start) / static_cast<double>(std::max<juce::int64>(stats->numSamplesDecoded, 1))));
+            }
+            const nvs::analysis::AnalysisResultFile::Info info {
+                SHA256(inputFile).toHexString(), analyzer.getSettingsHash(), reader->sampleRate, stats->numSamplesDecoded
+            };
+            if (!nvs::analysis::AnalysisResultFile::write(outputFile, info, onsets, measurements)) {
+                print("Error: could not write results to " + outputFile.getFullPathName());
+                return;
+            }
+            print("Results written to " + outputFile.getFullPathName());
+        }
+    };
+
+    // the files of --analyze-dir (recursively, any readable format) or --analyze-list (one path per line, relative
+    // to the list), in a stable order
+    auto getCorpusFiles = [&getInputFile] (const ArgumentList &args, const bool isList) -> Array<File>
+    {
+        Array<File> files;
+        const File input = getInputFile(args);
+        if (isList && input.existsAsFile()) {
+            StringArray lines;
+            input.readLines(lines);
+            for (auto const &line : lines) {
+                if (line.trim().isNotEmpty()) {
+                    files.add(input.getParentDirectory().getChildFile(line.trim()));
+                }
+            }
+        } else if (!isList && input.isDirectory()) {
+            AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+            files = input.findChildFiles(File::findFiles, true, formatManager.getWildcardForAllFormats());
+            files.sort();
+        }
+        return files;
+    };
+
+    auto batchAnalysisProgram = [print, &getCorpusFiles](const ArgumentList &args, const bool isList) -> void
+    {
+        const auto files = getCorpusFiles(args, isList);
+        if (files.isEmpty()) {
+            print(isList ? "Error: Please specify a list of audio files" : "Error: Please specify a directory of audio files");
+            return;
+        }
+        const String threadsOption = args.getValueForOption("--threads");
+        const auto numThreads = static_cast<size_t>(threadsOption.isNotEmpty() ? std::max(threadsOption.getIntValue(), 1)
+                                                                               : SystemStats::getNumCpus());
+        print("Analyzing " + String(files.size()) + " files on " + String(numThreads) + " threads...");
+
+        nvs::analysis::BatchAnalyzer batch(nvs::analysis::AnalyzerSettings{}, numThreads);
+        if (const String outputOption = args.getValueForOption("--output-dir"); outputOption.isNotEmpty()) {
+            batch.setOutputDirectory(File::getCurrentWorkingDirectory().getChildFile(outputOption));
+        }
+        if (args.containsOption("--cache")) {
+            batch.setCache(nvs::analysis::AnalysisCache::getDefault());
+        }
+        size_t numDone {0};
+        const auto stats = batch.run(std::vector<File>(files.begin(), files.end()),
+            [&](nvs::analysis::BatchAnalyzer::FileResult const &result) {
+                if (!result.succeeded) {
+                    print("Failed: " + result.file.getFullPathName());
+                }
+                if (++numDone % 100 == 0) {
+                    print(String(numDone) + " of " + String(files.size()) + " files done");
+                }
+            }, [] { return false; });
+
+        print("Batch analysis complete: " + String(stats.numFiles - stats.numFailed) + " of " + String(stats.numFiles)
+              + " files, " + String(stats.numEvents) + " events, in " + String(stats.seconds, 2) + " s");
+        print(String(stats.filesPerSecond(), 2) + " files/s, " + String(stats.audioSeconds, 1) + " s of audio ("
+              + String(stats.realtimeFactor(), 1) + "x real time)");
+    };
+
     app.addHelpCommand ("--help|-h", "TSN Analyzer - Audio timbre space analysis tool", true);
     app.addVersionCommand ("--version|-v", "TSN Analyzer version 0.1.0");
 
     app.addCommand ({
         "--analyze",
-        "--analyze <input_file>",
+        "--analyze <input_file> [--output=<results.tsnr>] [--cache]",
         "Analyzes the audio file and extracts timbre features",
         "This application analyzes an input audio file by splitting it into either events or " + newLine
         + String("uniformly-spaced frames, then analyzing each event/frame in terms of pitch, loudness, and" + newLine
-            + String("timbral features.")),
+            + String("timbral features. With --output, the results are written as a binary result file. With --cache," + newLine
+            + String("results are looked up in and stored to the analysis cache in the user's application data directory."))),
         mainAnalysisProgram
     });
 
+    app.addCommand ({
+        "--analyze-stream",
+        "--analyze-stream <input_file> [--window=<seconds>] [--output=<results.tsnr>]",
+        "Analyzes the audio file while decoding it, in bounded memory",
+        "Decodes the input file a chunk at a time while detecting onsets and describing events as the audio arrives, "
+        "as the live analyzer would, so memory is bounded by the window (4 s by default) rather than the file length. "
+        "With --output, the events are written as a binary result file, whose audio hash is of the encoded file.",
+        streamingAnalysisProgram
+    });
+
+    app.addCommand ({
+        "--analyze-dir",
+        "--analyze-dir <directory> [--threads=<n>] [--output-dir=<directory>] [--cache]",
+        "Analyzes every audio file in the directory and its subdirectories",
+        "Decodes the next files while analyzing the current ones, and runs several short files at once so their few "
+        "events still fill the cores. Reports files/s and total throughput at the end. With --output-dir, each file's "
+        "results are written there as a binary result file. With --cache, results are looked up in and stored to the "
+        "analysis cache.",
+        [&batchAnalysisProgram](const ArgumentList &args) { batchAnalysisProgram(args, false); }
+    });
+
+    app.addCommand ({
+        "--analyze-list",
+        "--analyze-list <list_file> [--threads=<n>] [--output-dir=<directory>] [--cache]",
+        "Analyzes the audio files listed in the file, one path per line",
+        "As --analyze-dir, over the listed files in order. Relative paths are resolved against the list's directory.",
+        [&batchAnalysisProgram](const ArgumentList &args) { batchAnalysisProgram(args, true); }
+    });
+
+    app.addCommand ({
+        "--benchmark",
+        "--benchmark <input_file> [benchmark_name]",
+        "Times analysis stages on the audio file",
+        "Runs the named benchmark (or all of them) on the input file and prints timings to stdout.",
+        benchmarkProgram
+    });
+
     return app.findAndRunCommand (argc, argv);
 }
\ No newline at end of file
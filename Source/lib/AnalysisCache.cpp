@@ -0,0 +1,192 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "AnalysisCache.h"
+#include <juce_cryptography/juce_cryptography.h>
+
+namespace nvs::analysis {
+
+namespace {
+
+constexpr juce::int32 magic {0x43'4E'53'54};    // "TSNC"
+constexpr juce::int32 formatVersion {1};
+const juce::String entryExtension {".tsncache"};
+
+// entries hold raw in-memory arrays, so they are only valid for the layout they were written with
+static_assert(std::is_trivially_copyable_v<FeatureContainer<EventwiseStatistics<Real>>>);
+static_assert(sizeof(FeatureContainer<EventwiseStatistics<Real>>)
+    == sizeof(Real) * static_cast<size_t>(Feature_e::NumFeatures) * static_cast<size_t>(Statistic::NumStatistics));
+
+struct EntryHeader {
+    juce::int32 magic;
+    juce::int32 version;
+    juce::int32 kind;
+    juce::int32 elementSize;
+    juce::int64 numElements;
+};
+
+}   // anonymous namespace
+
+AnalysisCache::AnalysisCache(juce::File directory, const juce::int64 maxBytes)
+:   _directory(std::move(directory))
+,   _maxBytes(maxBytes)
+{
+    if (const auto result = _directory.createDirectory(); result.failed()) {
+        std::cerr << "AnalysisCache: could not create " << _directory.getFullPathName() << ": "
+                  << result.getErrorMessage() << "\n";
+    }
+}
+
+std::shared_ptr<AnalysisCache> AnalysisCache::getDefault() {
+    static const auto cache = std::make_shared<AnalysisCache>(
+        juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile("NVS").getChildFile("tsn-analyzer").getChildFile("cache"),
+        defaultMaxBytes);
+    return cache;
+}
+
+juce::File AnalysisCache::getEntryFile(const Kind kind, const juce::String &audioHash, const juce::String &settingsHash) const {
+    const juce::String key = audioHash + "|" + settingsHash + "|" + juce::String(static_cast<int>(kind))
+                           + "|v" + juce::String(analysisVersion);
+    return _directory.getChildFile(juce::SHA256(key.toUTF8()).toHexString() + entryExtension);
+}
+
+std::optional<juce::MemoryBlock> AnalysisCache::read(const Kind kind, const juce::String &audioHash,
+                                                     const juce::String &settingsHash, const size_t elementSize) {
+    std::lock_guard lock(_mutex);
+    const auto file = getEntryFile(kind, audioHash, settingsHash);
+
+    juce::MemoryBlock block;
+    if (!file.existsAsFile() || !file.loadFileAsData(block) || block.getSize() < sizeof(EntryHeader)) {
+        ++_stats.misses;
+        return std::nullopt;
+    }
+    EntryHeader header {};
+    block.copyTo(&header, 0, sizeof(EntryHeader));
+    const auto payloadBytes = block.getSize() - sizeof(EntryHeader);
+    if (header.magic != magic || header.version != formatVersion || header.kind != static_cast<juce::int32>(kind)
+        || header.elementSize != static_cast<juce::int32>(elementSize)
+        || payloadBytes != static_cast<size_t>(header.numElements) * elementSize)
+    {
+        std::cerr << "AnalysisCache: discarding stale or corrupt entry " << file.getFileName() << "\n";
+        file.deleteFile();
+        ++_stats.misses;
+        return std::nullopt;
+    }
+    file.setLastModificationTime(juce::Time::getCurrentTime());   // most recently used
+    ++_stats.hits;
+    _stats.bytesSaved += static_cast<juce::int64>(payloadBytes);
+
+    block.removeSection(0, sizeof(EntryHeader));
+    return block;
+}
+
+void AnalysisCache::write(const Kind kind, const juce::String &audioHash, const juce::String &settingsHash,
+                          const void *data, const size_t numElements, const size_t elementSize) {
+    std::lock_guard lock(_mutex);
+    const auto file = getEntryFile(kind, audioHash, settingsHash);
+    const EntryHeader header {
+        .magic = magic,
+        .version = formatVersion,
+        .kind = static_cast<juce::int32>(kind),
+        .elementSize = static_cast<juce::int32>(elementSize),
+        .numElements = static_cast<juce::int64>(numElements)
+    };
+
+    juce::TemporaryFile temp(file);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (out.failedToOpen()
+            || !out.write(&header, sizeof(EntryHeader))
+            || !out.write(data, numElements * elementSize))
+        {
+            std::cerr << "AnalysisCache: could not write " << temp.getFile().getFullPathName() << "\n";
+            return;
+        }
+    }
+    if (!temp.overwriteTargetFileWithTemporary()) {
+        std::cerr << "AnalysisCache: could not move entry into " << file.getFullPathName() << "\n";
+        return;
+    }
+    ++_stats.stores;
+    evictToFit();
+}
+
+void AnalysisCache::evictToFit() {
+    auto entries = _directory.findChildFiles(juce::File::findFiles, false, "*" + entryExtension);
+    juce::int64 totalBytes {0};
+    for (auto const &f : entries) {
+        totalBytes += f.getSize();
+    }
+    if (totalBytes <= _maxBytes) {
+        return;
+    }
+    std::ranges::sort(entries, {}, [](const juce::File &f) { return f.getLastModificationTime().toMilliseconds(); });
+    for (auto const &f : entries) {
+        if (totalBytes <= _maxBytes) {
+            break;
+        }
+        const auto size = f.getSize();
+        if (f.deleteFile()) {
+            totalBytes -= size;
+            ++_stats.evictions;
+        }
+    }
+}
+
+std::optional<std::vector<float>> AnalysisCache::loadOnsets(const juce::String &audioHash, const juce::String &settingsHash) {
+    const auto block = read(Kind::Onsets, audioHash, settingsHash, sizeof(float));
+    if (!block.has_value()) {
+        return std::nullopt;
+    }
+    std::vector<float> onsets(block->getSize() / sizeof(float));
+    block->copyTo(onsets.data(), 0, block->getSize());
+    return onsets;
+}
+
+void AnalysisCache::storeOnsets(const juce::String &audioHash, const juce::String &settingsHash,
+                                const std::span<const float> onsets) {
+    write(Kind::Onsets, audioHash, settingsHash, onsets.data(), onsets.size(), sizeof(float));
+}
+
+std::optional<std::vector<FeatureContainer<EventwiseStatistics<Real>>>>
+AnalysisCache::loadTimbre(const juce::String &audioHash, const juce::String &settingsHash) {
+    using Point = FeatureContainer<EventwiseStatistics<Real>>;
+    const auto block = read(Kind::Timbre, audioHash, settingsHash, sizeof(Point));
+    if (!block.has_value()) {
+        return std::nullopt;
+    }
+    std::vector<Point> points(block->getSize() / sizeof(Point));
+    block->copyTo(points.data(), 0, block->getSize());
+    return points;
+}
+
+void AnalysisCache::storeTimbre(const juce::String &audioHash, const juce::String &settingsHash,
+                                const std::span<const FeatureContainer<EventwiseStatistics<Real>>> timbreMeasurements) {
+    write(Kind::Timbre, audioHash, settingsHash, timbreMeasurements.data(), timbreMeasurements.size(),
+          sizeof(FeatureContainer<EventwiseStatistics<Real>>));
+}
+
+auto AnalysisCache::getStats() const -> Stats {
+    std::lock_guard lock(_mutex);
+    return _stats;
+}
+
+juce::int64 AnalysisCache::getSizeInBytes() const {
+    std::lock_guard lock(_mutex);
+    juce::int64 totalBytes {0};
+    for (auto const &f : _directory.findChildFiles(juce::File::findFiles, false, "*" + entryExtension)) {
+        totalBytes += f.getSize();
+    }
+    return totalBytes;
+}
+
+void AnalysisCache::clear() {
+    std::lock_guard lock(_mutex);
+    for (auto const &f : _directory.findChildFiles(juce::File::findFiles, false, "*" + entryExtension)) {
+        f.deleteFile();
+    }
+}
+
+}   // namespace nvs::analysis
@@ -0,0 +1,75 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include "AnalysisUsing.h"
+#include "Features.h"
+#include "Statistics.h"
+
+namespace nvs::analysis {
+
+/**
+ * On-disk, content-addressed cache of analysis results keyed by (audioHash, settingsHash), so re-analyzing a file with
+ * settings it was already analyzed with is a file read. Entries are bounded in total size and evicted least recently
+ * used first (an entry's modification time is bumped on every hit).
+ * Entries are written to a temporary file and moved into place, so several processes can share one directory.
+ */
+class AnalysisCache {
+public:
+    struct Stats {
+        juce::int64 hits {0};
+        juce::int64 misses {0};
+        juce::int64 stores {0};
+        juce::int64 evictions {0};
+        juce::int64 bytesSaved {0};     // size of the results served from the cache instead of recomputed
+    };
+
+    AnalysisCache(juce::File directory, juce::int64 maxBytes);
+
+    // shared cache under the user's application data directory, bounded to defaultMaxBytes.
+    // nothing uses it unless asked to (ThreadedAnalyzer::setCache, BatchAnalyzer::setCache, the CLI's --cache)
+    static std::shared_ptr<AnalysisCache> getDefault();
+    static constexpr juce::int64 defaultMaxBytes {1024 * 1024 * 1024};
+
+    // part of every entry's key, so results computed by older code are never served: bump it with any change that
+    // alters analysis output for the same audio and settings
+    static constexpr juce::int32 analysisVersion {3};
+
+    std::optional<std::vector<float>> loadOnsets(const juce::String &audioHash, const juce::String &settingsHash);
+    void storeOnsets(const juce::String &audioHash, const juce::String &settingsHash, std::span<const float> onsets);
+
+    std::optional<std::vector<FeatureContainer<EventwiseStatistics<Real>>>>
+    loadTimbre(const juce::String &audioHash, const juce::String &settingsHash);
+    void storeTimbre(const juce::String &audioHash, const juce::String &settingsHash,
+                     std::span<const FeatureContainer<EventwiseStatistics<Real>>> timbreMeasurements);
+
+    Stats getStats() const;
+    juce::File getDirectory() const { return _directory; }
+    juce::int64 getSizeInBytes() const;
+    void clear();
+
+private:
+    enum class Kind : juce::int32 { Onsets = 0, Timbre = 1 };
+
+    const juce::File _directory;
+    const juce::int64 _maxBytes;
+    mutable std::mutex _mutex;
+    Stats _stats;
+
+    juce::File getEntryFile(Kind kind, const juce::String &audioHash, const juce::String &settingsHash) const;
+    // the entry's payload, or nullopt if it is missing or doesn't match the expected kind and element size
+    std::optional<juce::MemoryBlock> read(Kind kind, const juce::String &audioHash, const juce::String &settingsHash,
+                                          size_t elementSize);
+    void write(Kind kind, const juce::String &audioHash, const juce::String &settingsHash,
+               const void *data, size_t numElements, size_t elementSize);
+    void evictToFit();
+};
+
+}   // namespace nvs::analysis
@@ -0,0 +1,215 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "AnalysisResultFile.h"
+#include "OnsetAnalysis/OnsetProcessing.h"
+#include <array>
+
+namespace nvs::analysis {
+
+const juce::String AnalysisResultFile::fileExtension {".tsnr"};
+
+namespace {
+
+constexpr juce::int32 magic {0x52'4E'53'54};    // "TSNR"
+constexpr size_t sectionAlignment {64};
+constexpr size_t maxHashLength {127};
+constexpr auto numFeatures = static_cast<size_t>(Feature_e::NumFeatures);
+constexpr auto numStatistics = static_cast<size_t>(Statistic::NumStatistics);
+constexpr size_t numColumns = numFeatures * numStatistics;
+
+// the columns are in Feature_e order, each holding Statistic's in order: reordering either enum needs a new version
+static_assert(numFeatures == 22 && numStatistics == 5, "the result file layout changed: bump formatVersion");
+
+struct FileHeader {
+    juce::int32 magic;
+    juce::int32 version;
+    juce::int32 numFeatures;
+    juce::int32 numStatistics;
+    juce::int64 numEvents;
+    juce::int64 numOnsets;
+    juce::int64 onsetsOffset;       // bytes from the start of the file
+    juce::int64 columnsOffset;
+    juce::int64 columnStride;       // bytes from one column to the next
+    double sampleRate;
+    juce::int64 numSamples;         // the length of the wave the onsets are normalized to
+    char reserved[56];              // zeroed; keeps the header a whole number of sections
+    char audioHash[maxHashLength + 1];
+    char settingsHash[maxHashLength + 1];
+};
+static_assert(sizeof(FileHeader) == 384 && sizeof(FileHeader) % sectionAlignment == 0);
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+
+size_t alignUp(const size_t bytes) {
+    return (bytes + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+
+const FileHeader &getHeader(const char *bytes) {
+    return *reinterpret_cast<const FileHeader *>(bytes);
+}
+
+size_t getColumnIndex(const Feature_e feature, const Statistic statistic) {
+    return static_cast<size_t>(feature) * numStatistics + static_cast<size_t>(statistic);
+}
+
+// the members in Statistic order
+constexpr std::array statisticMembers {
+    &EventwiseStatistics<Real>::mean,
+    &EventwiseStatistics<Real>::median,
+    &EventwiseStatistics<Real>::variance,
+    &EventwiseStatistics<Real>::skewness,
+    &EventwiseStatistics<Real>::kurtosis
+};
+static_assert(statisticMembers.size() == numStatistics);
+
+bool writeBytes(juce::OutputStream &out, const void *data, const size_t numBytes) {
+    return numBytes == 0 || out.write(data, numBytes);
+}
+
+bool writePadding(juce::OutputStream &out, const size_t fromBytes) {
+    static constexpr std::array<char, sectionAlignment> zeros {};
+    return writeBytes(out, zeros.data(), alignUp(fromBytes) - fromBytes);
+}
+
+}   // anonymous namespace
+
+bool AnalysisResultFile::write(const juce::File &file, Info const &info, const std::span<const float> onsets,
+                               const std::span<const FeatureContainer<EventwiseStatistics<Real>>> timbreMeasurements)
+{
+    if (info.audioHash.getNumBytesAsUTF8() > maxHashLength || info.settingsHash.getNumBytesAsUTF8() > maxHashLength) {
+        std::cerr << "AnalysisResultFile: hash too long to store\n";
+        return false;
+    }
+    const size_t numEvents = timbreMeasurements.size();
+    FileHeader header {};
+    header.magic = magic;
+    header.version = formatVersion;
+    header.numFeatures = static_cast<juce::int32>(numFeatures);
+    header.numStatistics = static_cast<juce::int32>(numStatistics);
+    header.numEvents = static_cast<juce::int64>(numEvents);
+    header.numOnsets = static_cast<juce::int64>(onsets.size());
+    header.onsetsOffset = sizeof(FileHeader);
+    header.columnsOffset = static_cast<juce::int64>(alignUp(sizeof(FileHeader) + onsets.size_bytes()));
+    header.columnStride = static_cast<juce::int64>(alignUp(numEvents * sizeof(float)));
+    header.sampleRate = info.sampleRate;
+    header.numSamples = info.numSamples;
+    info.audioHash.copyToUTF8(header.audioHash, sizeof(header.audioHash));
+    info.settingsHash.copyToUTF8(header.settingsHash, sizeof(header.settingsHash));
+
+    juce::TemporaryFile temp(file);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        bool ok = !out.failedToOpen()
+            && writeBytes(out, &header, sizeof(FileHeader))
+            && writeBytes(out, onsets.data(), onsets.size_bytes())
+            && writePadding(out, sizeof(FileHeader) + onsets.size_bytes());
+        // transposed a column at a time, so the file holds each (feature, statistic) contiguously
+        std::vector<float> column(numEvents);
+        for (size_t c = 0; ok && c < numColumns; ++c) {
+            for (size_t e = 0; e < numEvents; ++e) {
+                column[e] = timbreMeasurements[e].features[c / numStatistics].*statisticMembers[c % numStatistics];
+            }
+            ok = writeBytes(out, column.data(), numEvents * sizeof(float)) && writePadding(out, numEvents * sizeof(float));
+        }
+        if (!ok) {
+            std::cerr << "AnalysisResultFile: could not write " << temp.getFile().getFullPathName() << "\n";
+            return false;
+        }
+    }
+    if (!temp.overwriteTargetFileWithTemporary()) {
+        std::cerr << "AnalysisResultFile: could not move results into " << file.getFullPathName() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool AnalysisResultFile::write(const juce::File &file, OnsetAnalysisResult const &onsets, TimbreAnalysisResult const &timbre,
+                               const juce::String &settingsHash, const double sampleRate)
+{
+    jassert (onsets.waveformHash == timbre.waveformHash);
+    const Info info { timbre.waveformHash, settingsHash, sampleRate, static_cast<juce::int64>(onsets.numSamples) };
+    return write(file, info, onsets.onsets, timbre.timbreMeasurements);
+}
+
+MappedAnalysisResultFile::MappedAnalysisResultFile(std::unique_ptr<juce::MemoryMappedFile> mapping)
+:   _mapping(std::move(mapping))
+{}
+
+std::unique_ptr<MappedAnalysisResultFile> MappedAnalysisResultFile::open(const juce::File &file) {
+    if (!file.existsAsFile()) {
+        return nullptr;
+    }
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto size = mapping->getSize();
+    if (mapping->getData() == nullptr || size < sizeof(FileHeader)) {
+        return nullptr;
+    }
+    const auto &header = getHeader(static_cast<const char *>(mapping->getData()));
+    const bool valid = header.magic == magic && header.version == AnalysisResultFile::formatVersion
+        && header.numFeatures == static_cast<juce::int32>(numFeatures)
+        && header.numStatistics == static_cast<juce::int32>(numStatistics)
+        && header.numEvents >= 0 && header.numOnsets >= 0 && header.numSamples >= 0
+        && header.onsetsOffset % static_cast<juce::int64>(sectionAlignment) == 0
+        && header.columnsOffset % static_cast<juce::int64>(sectionAlignment) == 0
+        && header.columnStride >= header.numEvents * static_cast<juce::int64>(sizeof(float))
+        && header.onsetsOffset + header.numOnsets * static_cast<juce::int64>(sizeof(float)) <= header.columnsOffset
+        && header.columnsOffset + static_cast<juce::int64>(numColumns - 1) * header.columnStride
+               + header.numEvents * static_cast<juce::int64>(sizeof(float)) <= static_cast<juce::int64>(size)
+        && header.audioHash[maxHashLength] == '\0' && header.settingsHash[maxHashLength] == '\0';
+    if (!valid) {
+        std::cerr << "MappedAnalysisResultFile: " << file.getFullPathName() << " is not a readable result file\n";
+        return nullptr;
+    }
+    return std::unique_ptr<MappedAnalysisResultFile>(new MappedAnalysisResultFile(std::move(mapping)));
+}
+
+AnalysisResultFile::Info MappedAnalysisResultFile::getInfo() const {
+    const auto &header = getHeader(bytes());
+    return {
+        .audioHash = juce::String::fromUTF8(header.audioHash),
+        .settingsHash = juce::String::fromUTF8(header.settingsHash),
+        .sampleRate = header.sampleRate,
+        .numSamples = header.numSamples
+    };
+}
+
+size_t MappedAnalysisResultFile::getNumEvents() const {
+    return static_cast<size_t>(getHeader(bytes()).numEvents);
+}
+
+std::span<const float> MappedAnalysisResultFile::getOnsets() const {
+    const auto &header = getHeader(bytes());
+    return { reinterpret_cast<const float *>(bytes() + header.onsetsOffset), static_cast<size_t>(header.numOnsets) };
+}
+
+std::vector<float> MappedAnalysisResultFile::getOnsetsInSeconds() const {
+    const auto &header = getHeader(bytes());
+    const auto onsets = getOnsets();
+    std::vector<float> seconds(onsets.begin(), onsets.end());
+    if (header.sampleRate > 0.0) {
+        denormalizeOnsets(seconds, static_cast<double>(header.numSamples) / header.sampleRate);
+    }
+    return seconds;
+}
+
+std::span<const float> MappedAnalysisResultFile::getColumn(const Feature_e feature, const Statistic statistic) const {
+    const auto &header = getHeader(bytes());
+    const auto offset = header.columnsOffset + static_cast<juce::int64>(getColumnIndex(feature, statistic)) * header.columnStride;
+    return { reinterpret_cast<const float *>(bytes() + offset), static_cast<size_t>(header.numEvents) };
+}
+
+std::vector<FeatureContainer<EventwiseStatistics<Real>>> MappedAnalysisResultFile::getTimbreMeasurements() const {
+    std::vector<FeatureContainer<EventwiseStatistics<Real>>> measurements(getNumEvents());
+    for (size_t f = 0; f < numFeatures; ++f) {
+        for (size_t s = 0; s < numStatistics; ++s) {
+            const auto column = getColumn(static_cast<Feature_e>(f), static_cast<Statistic>(s));
+            for (size_t e = 0; e < column.size(); ++e) {
+                measurements[e].features[f].*statisticMembers[s] = column[e];
+            }
+        }
+    }
+    return measurements;
+}
+
+}   // namespace nvs::analysis
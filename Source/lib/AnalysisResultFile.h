@@ -0,0 +1,69 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include "AnalysisUsing.h"
+#include "Features.h"
+#include "Statistics.h"
+#include "OnsetAnalysis/OnsetAnalysisResult.h"
+#include "TimbreAnalysis/TimbreAnalysisResult.h"
+
+namespace nvs::analysis {
+
+/**
+ * Versioned binary file of one file's analysis results, laid out to be used straight from a memory mapping:
+ * a fixed header (audio hash, settings hash, sample rate and length of the wave, counts), the onsets, then one contiguous
+ * float column per (feature, statistic) holding that value for every event. Every section starts 64-byte aligned.
+ * The onsets are stored normalized (0..1) to the wave's length; getOnsetsInSeconds() scales them back.
+ * Values are stored in the host's byte order; a file written with the other one is rejected by its magic number.
+ */
+struct AnalysisResultFile {
+    static constexpr juce::int32 formatVersion {2};
+    static const juce::String fileExtension;
+
+    struct Info {
+        juce::String audioHash;
+        juce::String settingsHash;
+        double sampleRate {0.0};
+        juce::int64 numSamples {0};     // the length of the analyzed wave, which the onsets are normalized to
+    };
+
+    // written to a temporary file and moved into place. false if it could not be written (or a hash is too long)
+    static bool write(const juce::File &file, Info const &info, std::span<const float> onsets,
+                      std::span<const FeatureContainer<EventwiseStatistics<Real>>> timbreMeasurements);
+    // the results of one ThreadedAnalyzer run
+    static bool write(const juce::File &file, OnsetAnalysisResult const &onsets, TimbreAnalysisResult const &timbre,
+                      const juce::String &settingsHash, double sampleRate);
+};
+
+// a result file mapped into memory. opening checks the header only; the columns are read in place.
+class MappedAnalysisResultFile {
+public:
+    // nullptr if the file is missing, not a result file, of another version, or truncated
+    static std::unique_ptr<MappedAnalysisResultFile> open(const juce::File &file);
+
+    AnalysisResultFile::Info getInfo() const;
+    size_t getNumEvents() const;
+    // normalized to the wave's length, as written
+    std::span<const float> getOnsets() const;
+    // the onsets scaled by the stored length and sample rate
+    std::vector<float> getOnsetsInSeconds() const;
+    // one statistic of one feature, for every event
+    std::span<const float> getColumn(Feature_e feature, Statistic statistic) const;
+    // the events gathered back into the in-memory layout, for code that takes it
+    std::vector<FeatureContainer<EventwiseStatistics<Real>>> getTimbreMeasurements() const;
+
+private:
+    explicit MappedAnalysisResultFile(std::unique_ptr<juce::MemoryMappedFile> mapping);
+
+    std::unique_ptr<juce::MemoryMappedFile> _mapping;
+    const char *bytes() const { return static_cast<const char *>(_mapping->getData()); }
+};
+
+}   // namespace nvs::analysis
@@ -0,0 +1,140 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "AnalysisScheduler.h"
+#include <algorithm>
+#include <juce_core/juce_core.h>
+
+namespace nvs::analysis {
+
+AnalysisScheduler::AnalysisScheduler(const size_t numThreads) {
+    const size_t n = std::max<size_t>(numThreads, 1);
+    _workers.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    // start only once every deque exists, since workers steal from each other
+    for (size_t i = 0; i < n; ++i) {
+        _workers[i]->thread = std::thread([this, i] {
+            juce::Thread::setCurrentThreadName("TimbreAnalysis" + juce::String(i));
+            workerLoop(i);
+        });
+    }
+}
+
+AnalysisScheduler::~AnalysisScheduler() {
+    {
+        std::lock_guard lock(_wakeMutex);
+        _stop.store(true);
+    }
+    _wake.notify_all();
+    for (auto &w : _workers) {
+        if (w->thread.joinable()) {
+            w->thread.join();
+        }
+    }
+}
+
+double AnalysisScheduler::BatchStats::utilization() const {
+    if (wallMs <= 0.0 || busyMs.empty()) {
+        return 0.0;
+    }
+    double totalBusyMs {0.0};
+    for (const auto b : busyMs) {
+        totalBusyMs += b;
+    }
+    return totalBusyMs / (wallMs * static_cast<double>(busyMs.size()));
+}
+
+auto AnalysisScheduler::parallelFor(const size_t numTasks, const TaskFn &task) -> BatchStats {
+    const size_t numWorkers = _workers.size();
+    if (numTasks == 0) {
+        return {0.0, std::vector<double>(numWorkers, 0.0)};
+    }
+    const auto start = Clock::now();
+    Batch batch(numTasks, numWorkers, task);
+
+    // counted before any job is pushed: a worker still running the previous batch may pop one of these straight away,
+    // and its decrement must not wrap the count
+    {
+        std::lock_guard lock(_wakeMutex);
+        _numQueued.fetch_add(numTasks);
+    }
+    for (size_t w = 0; w < numWorkers && w < numTasks; ++w) {
+        std::lock_guard lock(_workers[w]->mutex);
+        for (size_t i = w; i < numTasks; i += numWorkers) {
+            _workers[w]->jobs.push_back({&batch, i});
+        }
+    }
+    _wake.notify_all();
+
+    batch.remaining.wait();
+
+    if (batch.exception) {
+        std::rethrow_exception(batch.exception);
+    }
+    return {
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count(),
+        std::move(batch.busyMs)
+    };
+}
+
+bool AnalysisScheduler::tryPopOwn(const size_t workerIndex, Job &job) {
+    auto &w = *_workers[workerIndex];
+    std::lock_guard lock(w.mutex);
+    if (w.jobs.empty()) {
+        return false;
+    }
+    job = w.jobs.front();
+    w.jobs.pop_front();
+    return true;
+}
+
+bool AnalysisScheduler::trySteal(const size_t thiefIndex, Job &job) {
+    const size_t numWorkers = _workers.size();
+    for (size_t k = 1; k < numWorkers; ++k) {
+        auto &victim = *_workers[(thiefIndex + k) % numWorkers];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void AnalysisScheduler::execute(const Job &job, const size_t workerIndex) {
+    Batch &batch = *job.batch;
+    const auto start = Clock::now();
+    try {
+        batch.task(job.taskIndex, workerIndex);
+    } catch (...) {
+        std::lock_guard lock(batch.exceptionMutex);
+        if (!batch.exception) {
+            batch.exception = std::current_exception();
+        }
+    }
+    batch.busyMs[workerIndex] += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    // last access to the batch: once the latch reaches zero, parallelFor returns and the batch is destroyed
+    batch.remaining.count_down();
+}
+
+void AnalysisScheduler::workerLoop(const size_t workerIndex) {
+    while (true) {
+        Job job {};
+        if (tryPopOwn(workerIndex, job) || trySteal(workerIndex, job)) {
+            _numQueued.fetch_sub(1);
+            execute(job, workerIndex);
+            continue;
+        }
+        std::unique_lock lock(_wakeMutex);
+        _wake.wait(lock, [this] { return _stop.load() || _numQueued.load() > 0; });
+        if (_stop.load()) {
+            return;
+        }
+    }
+}
+
+}   // namespace nvs::analysis
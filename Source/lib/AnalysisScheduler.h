@@ -0,0 +1,87 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nvs::analysis {
+
+/**
+ * Long-lived pool of analysis workers, owned by Analyzer so threads are started once rather than per analysis call.
+ * Each worker has its own deque of tasks in index order: it takes its own tasks from the front and, when empty, steals
+ * the front of another's. So tasks sorted by descending cost are run longest-first (LPT), whoever runs them.
+ * A batch submitted through parallelFor completes through a latch, so the caller blocks without polling.
+ */
+class AnalysisScheduler {
+public:
+    // task(taskIndex, workerIndex). workerIndex is in [0, getNumThreads()) and can index per-worker scratch.
+    using TaskFn = std::function<void(size_t taskIndex, size_t workerIndex)>;
+
+    explicit AnalysisScheduler(size_t numThreads);
+    ~AnalysisScheduler();
+
+    AnalysisScheduler(const AnalysisScheduler&) = delete;
+    AnalysisScheduler &operator=(const AnalysisScheduler&) = delete;
+
+    size_t getNumThreads() const { return _workers.size(); }
+
+    // how well one parallelFor kept the workers busy
+    struct BatchStats {
+        double wallMs {0.0};
+        std::vector<double> busyMs;     // per worker, time spent inside tasks
+        // fraction of (wall time x workers) spent inside tasks; stragglers show up as low utilization
+        double utilization() const;
+    };
+
+    // runs task for every index in [0, numTasks) and blocks until all have finished.
+    // tasks are dealt out round-robin, so each worker starts with the lowest indices it holds.
+    // if a task throws, the remaining tasks still run and the first exception is rethrown here.
+    // several threads may call it at once (e.g. analyzers sharing one scheduler); their tasks share the workers.
+    BatchStats parallelFor(size_t numTasks, const TaskFn &task);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Batch {
+        Batch(const size_t numTasks, const size_t numWorkers, const TaskFn &t)
+        :   task(t), remaining(static_cast<std::ptrdiff_t>(numTasks)), busyMs(numWorkers, 0.0) {}
+        const TaskFn &task;
+        std::latch remaining;
+        std::vector<double> busyMs;     // each slot written only by its worker
+        std::mutex exceptionMutex;
+        std::exception_ptr exception;
+    };
+    struct Job {
+        Batch *batch;
+        size_t taskIndex;
+    };
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    std::atomic<size_t> _numQueued {0};
+    std::atomic<bool> _stop {false};
+
+    void workerLoop(size_t workerIndex);
+    bool tryPopOwn(size_t workerIndex, Job &job);
+    bool trySteal(size_t thiefIndex, Job &job);
+    static void execute(const Job &job, size_t workerIndex);
+};
+
+}   // namespace nvs::analysis
@@ -9,22 +9,47 @@
 */
 
 #include <concepts>
+#include <algorithm>
 
 #include <juce_audio_formats/juce_audio_formats.h>
 #include "Analyzer.h"
 #include <juce_utils.h>
-#include "OnsetAnalysis/OnsetAnalysis.h"
+#include "TimbreAnalysis/EventFramePipeline.h"
+#include "StringAxiom.h"
 
 namespace nvs::analysis {
 
 using Thread = juce::Thread;
 
+namespace {
+// numThreads changes speed, not results, so the settings hash and stage keys are taken without it. otherwise files
+// analyzed with the same settings on different thread counts (as BatchAnalyzer's are) would hash differently
+juce::ValueTree withoutNumThreads(const juce::ValueTree &settingsTree) {
+    auto copy = settingsTree.createCopy();
+    copy.getChildWithName(axiom::tsn::Analysis).removeProperty(axiom::tsn::numThreads, nullptr);
+    return copy;
+}
+}   // anonymous namespace
 
 Analyzer::Analyzer()
 :	ess_init()  // don't delete this seemingly unnecessary construction-it is a good reminder that ess_init MUST be initialized first
 ,	ess_hold(ess_init)
 {}
 
+AnalysisScheduler &Analyzer::getScheduler() const {
+    std::lock_guard lock(_schedulerMutex);
+    if (_scheduler == nullptr) {
+        _scheduler = std::make_shared<AnalysisScheduler>(static_cast<size_t>(std::max(settings.analysis.numThreads, 1)));
+    }
+    return *_scheduler;
+}
+
+void Analyzer::setScheduler(std::shared_ptr<AnalysisScheduler> scheduler) {
+    std::lock_guard lock(_schedulerMutex);
+    _schedulerIsShared = scheduler != nullptr;
+    _scheduler = std::move(scheduler);
+}
+
 bool Analyzer::updateSettings(juce::ValueTree &newSettings, const bool attemptFix){
     // verify tree structure
     bool valid {false};
@@ -35,9 +60,21 @@ bool Analyzer::updateSettings(juce::ValueTree &newSettings, const bool attemptFi
     }
     jassert (newSettings.getParent().getChildWithName("FileInfo").hasProperty("sampleRate"));
 
+    // parsed into a copy, so a tree that fails part way (e.g. an empty pitch range) leaves the settings untouched
+    AnalyzerSettings parsed = settings;
+    valid = valid && updateSettingsFromValueTree(parsed, newSettings);
+
     if (valid){
-        updateSettingsFromValueTree(settings, newSettings);
-        _settingsHash = util::hashValueTree(newSettings);
+        settings = std::move(parsed);
+        auto hashedSettings = withoutNumThreads(newSettings);
+        _settingsHash = util::hashValueTree(hashedSettings);
+        updateStageKeys(hashedSettings);
+        std::lock_guard lock(_schedulerMutex);
+        if (const auto numThreads = static_cast<size_t>(std::max(settings.analysis.numThreads, 1));
+            !_schedulerIsShared && _scheduler != nullptr && _scheduler->getNumThreads() != numThreads)
+        {
+            _scheduler.reset();     // restarted with the new count on next use
+        }
     }
     else {
         std::cerr << "settings tree invalid\n";
@@ -53,37 +90,88 @@ float Analyzer::getAnalyzedFileSampleRate() const {
     return static_cast<float>(settings.analysis.sampleRate);
 }
 
+void Analyzer::updateStageKeys(const juce::ValueTree &settingsTree) {
+    for (auto const &[branchName, _] : specsByBranch) {
+        auto branch = settingsTree.getChildWithName(branchName);
+        _branchHashes[branchName] = util::hashValueTree(branch);
+    }
+    const auto sampleRateKey = "sampleRate=" + juce::String(settings.analysis.sampleRate);
+
+    _stageKeys.onsetDetection = onsetDetectionKey(settings);
+    _stageKeys.onsetPicking = _stageKeys.onsetDetection + "|" + getBranchHash(axiom::tsn::Onset);
+    _stageKeys.eventDescription = sampleRateKey
+        + "|" + getBranchHash(axiom::tsn::Analysis)
+        + "|" + getBranchHash(axiom::tsn::BFCC)
+        + "|" + getBranchHash(axiom::tsn::Pitch)
+        + "|" + getBranchHash(axiom::tsn::Loudness)
+        + "|" + getBranchHash(axiom::tsn::Split);
+}
+
+juce::String Analyzer::getBranchHash(const juce::String &branchName) const {
+    const auto it = _branchHashes.find(branchName);
+    jassert (it != _branchHashes.end());
+    return it != _branchHashes.end() ? it->second : juce::String{};
+}
+
 std::optional<vecReal> Analyzer::calculateOnsetsInSeconds(const vecReal &wave, RunLoopStatus& rls, const ShouldExitFn &shouldExit) const {
     if (wave.empty()){
         return std::nullopt;
     }
 
     if (settings.onset.segmentation == AnalyzerSettings::Onset::Segmentation::Uniform) {
-        // make a vecReal of evenly distributed onsets
-        const float dt = 0.05f;
-        const auto L_sec = getLengthInSeconds(wave.size(), settings.analysis.sampleRate);
-        vecReal onsets (static_cast<size_t>(L_sec / dt));
-        for (size_t i = 0; i < onsets.size(); ++i) {
-            onsets[i] = static_cast<Real>(i) * dt;
-        }
-        return onsets;
+        return calculateUniformOnsets(wave.size());
+    }
+
+    const auto onsets2d = calculateOnsetDetectionMatrix(wave, rls, shouldExit);
+    if (!onsets2d.has_value()) {
+        return std::nullopt;
+    }
+    return pickOnsets(onsets2d.value());
+}
+
+vecReal Analyzer::calculateUniformOnsets(const size_t waveLength) const {
+    // make a vecReal of evenly distributed onsets
+    const float dt = 0.05f;
+    const auto L_sec = getLengthInSeconds(waveLength, settings.analysis.sampleRate);
+    vecReal onsets (static_cast<size_t>(L_sec / dt));
+    for (size_t i = 0; i < onsets.size(); ++i) {
+        onsets[i] = static_cast<Real>(i) * dt;
     }
+    return onsets;
+}
 
-    const analysis::array2dReal onsets2d = calculateOnsetsMatrix(wave, ess_hold.factory, settings, rls, shouldExit);
+std::optional<array2dReal> Analyzer::calculateOnsetDetectionMatrix(const vecReal &wave, RunLoopStatus& rls,
+                                                                  const ShouldExitFn &shouldExit) const {
+    if (wave.empty()){
+        return std::nullopt;
+    }
+    // the detection functions are computed in time chunks across the scheduler's workers (the result matches the
+    // single network's within float tolerance; see the onsetChunks benchmark)
+    analysis::array2dReal onsets2d = (settings.analysis.numThreads > 1)
+        ? calculateOnsetsMatrixInChunks(wave, ess_hold.factory, settings, getScheduler(), rls, shouldExit)
+        : calculateOnsetsMatrix(wave, ess_hold.factory, settings, rls, shouldExit);
+    if (shouldExit()) {
+        return std::nullopt;    // the network stopped early, so the matrix is incomplete
+    }
     std::cout << "analyzed onsets\n";
+    return onsets2d;
+}
+
+vecReal Analyzer::pickOnsets(const array2dReal &onsetDetectionMatrix) const {
     const essentia::standard::AlgorithmFactory &tmpStFac = essentia::standard::AlgorithmFactory::instance();
 
 #pragma message("it is a problem that we have not the ability to inject a runLoopCallback here, since onsetsInSeconds uses StandardFactory instead of StreamingFactory")
 
-    std::vector<float> onsetsInSeconds = analysis::calculateOnsetsInSeconds(onsets2d, tmpStFac, settings);	// explicit namespace qualifier for clarity
+    std::vector<float> onsetsInSeconds = analysis::calculateOnsetsInSeconds(onsetDetectionMatrix, tmpStFac, settings);	// explicit namespace qualifier for clarity
     std::cout << "calculated onsets in seconds\n";
 
     return onsetsInSeconds;
 }
 
 
+// weighted mean of each column, accumulated row by row over the contiguous frames
 template <typename T>
-static std::vector<T> weightedMeanFrames(const std::vector<std::vector<T>>& frames,
+static std::vector<T> weightedMeanFrames(const FeatureMatrix<T>& frames,
                                    const std::vector<T>& weights,
                                    int beginIdx = 0,
                                    int endIdx = -1) {
@@ -91,28 +179,29 @@ static std::vector<T> weightedMeanFrames(const std::vector<std::vector<T>>& fram
         throw EssentiaException("trying to calculate mean of empty array of frames");
     }
 
-    if (endIdx == -1) endIdx = static_cast<int>(frames.size());
+    if (endIdx == -1) endIdx = static_cast<int>(frames.numRows());
 
-    if (weights.size() != frames.size()) {
+    if (weights.size() != frames.numRows()) {
         throw EssentiaException("weights vector must match frames vector size");
     }
 
-    uint vsize = frames[0].size();
+    const size_t vsize = frames.numColumns();
     std::vector<T> result(vsize, static_cast<T>(0.0));
     T totalWeight = static_cast<T>(0.0);
 
     for (int i = beginIdx; i < endIdx; ++i) {
-        T weight = weights[i];
+        const T weight = weights[i];
         totalWeight += weight;
 
-        for (uint j = 0; j < vsize; ++j) {
-            result[j] += frames[i][j] * weight;
+        const std::span<const T> frame = frames.rowSpan(static_cast<size_t>(i));
+        for (size_t j = 0; j < vsize; ++j) {
+            result[j] += frame[j] * weight;
         }
     }
 
     // Normalize by total weight
     if (totalWeight > static_cast<T>(0.0)) {
-        for (uint j = 0; j < vsize; ++j) {
+        for (size_t j = 0; j < vsize; ++j) {
             result[j] /= totalWeight;
         }
     }
@@ -121,87 +210,67 @@ static std::vector<T> weightedMeanFrames(const std::vector<std::vector<T>>& fram
 }
 
 
+static Analyzer::EventwiseStats describeFrames(const vecReal &frameValues) {
+    if (frameValues.empty()) {
+        return {};
+    }
+    const auto m = mean(frameValues);
+    return {
+        .mean = m,
+        .median = essentia::median(frameValues),
+        .variance = essentia::variance(frameValues, m),
+        .skewness = essentia::skewness(frameValues, m),
+        .kurtosis = essentia::kurtosis(frameValues, m)
+    };
+}
+
+static void describeTimbreFrames(const TimbreFrames &timbres_tmp, const AnalyzerSettings &settings,
+                                 FeatureContainer<Analyzer::EventwiseStats> &features) {
+    if (timbres_tmp.empty()) {
+        return;
+    }
+    vecReal frameWeights;
+    frameWeights.reserve(timbres_tmp.numRows());
+    for (auto const &bfcc0: timbres_tmp.column(static_cast<size_t>(Feature_e::bfcc0))) {
+        const Real weight = std::exp(bfcc0 * settings.bfcc.BFCC0_frameNormalizationFactor);
+        frameWeights.push_back(weight);
+    }
+    const vecReal means = weightedMeanFrames(timbres_tmp, frameWeights);
+
+    jassert(static_cast<size_t>(Feature_e::bfcc0) == 0); // because we're going to be editing the array of features from here
+    jassert(timbres_tmp.numColumns() == NumTimbralFeatures);
+
+    vecReal featureFrames(timbres_tmp.numRows());   // one feature across all frames; reused for every feature
+    for (size_t i = 0; i < timbres_tmp.numColumns(); ++i) {
+        const auto column = timbres_tmp.column(i);
+        std::copy(column.begin(), column.end(), featureFrames.begin());
+        features.features[i] = describeFrames(featureFrames);
+        features.features[i].mean = means[i];
+    }
+}
+
 void Analyzer::calculateEventwisePitchDescription(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features) const {
     const auto [pitches, confidences] = calculatePitchesAndConfidences(waveEvent, settings);
 #pragma message("not using confidences yet")
 
-    const auto p_mean = mean(pitches);
-    const auto c_mean = mean(confidences);
-
-    features[Feature_e::f0] = {
-        EventwiseStats {
-            .mean = p_mean,
-            .median = essentia::median(pitches),
-            .variance = essentia::variance(pitches, p_mean),
-            .skewness = essentia::skewness(pitches, p_mean),
-            .kurtosis = essentia::kurtosis(pitches, p_mean)
-        }
-    };
-    features[Feature_e::Periodicity] = {
-        EventwiseStats {
-            .mean = c_mean,
-            .median = essentia::median(confidences),
-            .variance = essentia::variance(confidences, c_mean),
-            .skewness = essentia::skewness(confidences, c_mean),
-            .kurtosis = essentia::kurtosis(confidences, c_mean)
-        }
-    };
+    features[Feature_e::f0] = describeFrames(pitches);
+    features[Feature_e::Periodicity] = describeFrames(confidences);
 }
 
 void Analyzer::calculateEventwiseLoudness(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features) const {
     const vecReal l_tmp = calculateLoudnesses(waveEvent, settings);
 
-    const auto l_mean = mean(l_tmp);
-
-    features[Feature_e::Loudness] = {
-        .mean = l_mean,
-        .median = essentia::median(l_tmp),
-        .variance = essentia::variance(l_tmp, l_mean),
-        .skewness = essentia::skewness(l_tmp, l_mean),
-        .kurtosis = essentia::kurtosis(l_tmp, l_mean)
-    };
+    features[Feature_e::Loudness] = describeFrames(l_tmp);
 }
 
 void Analyzer::calculateEventwiseTimbreDescription(const vecReal &waveEvent, FeatureContainer<EventwiseStats> &features) const {
-    const FeatureContainer<vecReal> timbres_tmp = calculateTimbres(waveEvent, settings);
-
-    // const vecReal means = essentia::meanFrames(b_tmp);	// get mean per bfcc across all frames
-    vecReal frameWeights;
-    frameWeights.reserve(timbres_tmp.features.size());
-    for (auto const &bfcc0: timbres_tmp[Feature_e::bfcc0]) {
-        const Real weight = std::exp(bfcc0 * settings.bfcc.BFCC0_frameNormalizationFactor);
-        frameWeights.push_back(weight);
-    }
-    const vecVecReal featurewiseFrames = transpose(std::span(timbres_tmp.features).first(NumTimbralFeatures));
-
-    const vecReal means = weightedMeanFrames(featurewiseFrames, frameWeights);
-    const vecReal  medians = medianFrames(featurewiseFrames);
-    const vecReal  variances = varianceFrames(featurewiseFrames);
-    const vecReal  skewnesses = skewnessFrames(featurewiseFrames);
-    const vecReal  kurtoses = kurtosisFrames(featurewiseFrames);
-
-    jassert(static_cast<size_t>(Feature_e::bfcc0) == 0); // because we're going to be editing the array of features from here
-    const auto stats = std::array {
-        &means,
-        &medians,
-        &variances,
-        &skewnesses,
-        &kurtoses
-    };
-    const auto supposedSize = means.size();
-    std::ranges::all_of(stats, [supposedSize](const vecReal *v) {
-        return v->size() < static_cast<size_t>(Feature_e::NumFeatures) && v->size() == supposedSize;
-    });
+    const TimbreFrames timbres_tmp = calculateTimbres(waveEvent, settings);
+    describeTimbreFrames(timbres_tmp, settings, features);
+}
 
-    for (size_t i = 0; i < means.size(); ++i) { // end at size of stats because that should be number of timbral features
-        features.features[i] = {
-            .mean = means[i],
-            .median = medians[i],
-            .variance = variances[i],
-            .skewness = skewnesses[i],
-            .kurtosis = kurtoses[i]
-        };
-    }
+void Analyzer::calculateEventwiseDescription(const std::span<Real const> waveEvent, FeatureContainer<EventwiseStats> &features) const {
+    EventFramePipeline &pipeline = EventFramePipeline::getForCurrentThread(settings, _stageKeys.eventDescription);
+    features = pipeline.process(waveEvent);
 }
 
 auto Analyzer::calculateOnsetwiseTimbreSpace(const vecReal &wave,
@@ -219,62 +288,93 @@ const -> std::optional<std::vector<FeatureContainer<EventwiseStats>>>
 
     rls.set("Splitting Wave into Events...");
 
-    const vecVecReal events = splitWaveIntoEvents(wave, onsetsInSeconds, ess_hold.factory, settings, rls, shouldExit);
+    const std::vector<EventView> events = calculateEventViews(wave.size(), onsetsInSeconds, settings);
 #pragma message("probably could benefit from some normalization, possibly based on variance")
 
+    AnalysisScheduler::BatchStats batchStats;
+    auto timbre_points = calculateEventwiseDescriptions(getScheduler(), wave, events, rls, shouldExit, &batchStats);
+    if (!timbre_points.has_value()) {
+        return std::nullopt;
+    }
+
+    std::cout << "calculated all BFCCs\n";
+
+    const double endMs   = juce::Time::getMillisecondCounterHiRes();
+    const auto   endTimeStr   = juce::Time::getCurrentTime().toString (true, true);
+    const double elapsed = (endMs - startMs) * 0.001f;  // in seconds
+
+    std::cout << "calculateOnsetwiseTimbreSpace end:   " << endTimeStr << "\n";
+    std::cout << "\t\t\t Elapsed time:   " << juce::String (elapsed, 3) << " seconds\n";
+    DBG("Core utilization: " << juce::String (100.0 * batchStats.utilization(), 1) << "% of "
+        << static_cast<int>(batchStats.busyMs.size()) << " workers");
+
+    return timbre_points;
+}
+
+auto Analyzer::calculateEventwiseDescriptions(const vecReal &wave,
+                                              const std::span<EventView const> events,
+                                              RunLoopStatus& rls, const ShouldExitFn &shouldExit,
+                                              AnalysisScheduler::BatchStats *batchStats)
+const -> std::optional<std::vector<FeatureContainer<EventwiseStats>>>
+{
+    return calculateEventwiseDescriptions(getScheduler(), wave, events, rls, shouldExit, batchStats);
+}
+
+auto Analyzer::calculateEventwiseDescriptions(AnalysisScheduler &scheduler,
+                                              const vecReal &wave,
+                                              const std::span<EventView const> events,
+                                              RunLoopStatus& rls, const ShouldExitFn &shouldExit,
+                                              AnalysisScheduler::BatchStats *batchStats)
+const -> std::optional<std::vector<FeatureContainer<EventwiseStats>>>
+{
     const size_t numEvents = events.size();
-    std::vector<FeatureContainer<EventwiseStatistics<Real>>> timbre_points(numEvents);
+    std::vector<FeatureContainer<EventwiseStats>> timbre_points(numEvents);
 
-    const auto threadPoolOptions = juce::ThreadPoolOptions()
-        .withNumberOfThreads(settings.analysis.numThreads)
-        .withDesiredThreadPriority(Thread::Priority::high)
-        .withThreadName("TimbreAnalysis")
-        .withThreadStackSizeBytes(Thread::osDefaultStackSize);
-    juce::ThreadPool pool(threadPoolOptions);
+    // enough chunks per worker for stealing to even out uneven event lengths, few enough that task overhead vanishes
+    constexpr size_t chunksPerWorker {16};
+    size_t totalSamples {0};
+    for (auto const &e : events) {
+        totalSamples += e.length;
+    }
+    const size_t targetSamples = std::max<size_t>(totalSamples / (scheduler.getNumThreads() * chunksPerWorker), 1);
+    std::vector<EventChunk> chunks = chunkEventsBySampleCount(events, targetSamples);
+
+    // longest-first: event lengths span orders of magnitude, and in onset order a long final event becomes a straggler
+    auto const chunkSamples = [&events](const EventChunk &c) {
+        size_t samples {0};
+        for (size_t i = c.begin; i < c.end; ++i) {
+            samples += events[i].length;
+        }
+        return samples;
+    };
+    std::ranges::stable_sort(chunks, std::greater{}, chunkSamples);
 
     std::atomic<size_t> completed {0};
     std::atomic<bool> cancelled {false};
 
     rls.set("Calculating timbre descriptions per event...");
-    for (size_t i = 0; i < numEvents; ++i) {
-        pool.addJob([&, i] {
-            if (cancelled.load(std::memory_order_relaxed) || shouldExit()) {
+    auto stats = scheduler.parallelFor(chunks.size(), [&](const size_t chunkIndex, size_t) {
+        for (size_t i = chunks[chunkIndex].begin; i < chunks[chunkIndex].end; ++i) {
+            if (cancelled.load(std::memory_order_relaxed)) {
                 return;
             }
-            const auto &e = events[i];
-            FeatureContainer<EventwiseStats> f;
-            calculateEventwiseTimbreDescription(e, f);
-            calculateEventwisePitchDescription(e, f);
-            calculateEventwiseLoudness(e, f);
-            timbre_points[i] = f;
-
-            if (const auto numDone = ++completed;
-                numDone % 4 == 0)
-            {
-                rls.set(static_cast<double>(numDone) / numEvents);
-            }
             if (shouldExit()) {
                 cancelled.store(true, std::memory_order_relaxed);
+                return;
             }
-        });
-    }
-    while (pool.getNumJobs() > 0) {
-        Thread::sleep(10);  // sleep between checks
+            calculateEventwiseDescription(events[i].of(wave), timbre_points[i]);
+        }
+        const auto numDone = completed.fetch_add(chunks[chunkIndex].end - chunks[chunkIndex].begin)
+                           + (chunks[chunkIndex].end - chunks[chunkIndex].begin);
+        rls.set(static_cast<double>(numDone) / static_cast<double>(numEvents));
+    });
+    if (batchStats != nullptr) {
+        *batchStats = std::move(stats);
     }
 
-    std::cout << "calculated all BFCCs\n";
-
     if (cancelled.load() || shouldExit()) {
         return std::nullopt;
     }
-
-    const double endMs   = juce::Time::getMillisecondCounterHiRes();
-    const auto   endTimeStr   = juce::Time::getCurrentTime().toString (true, true);
-    const double elapsed = (endMs - startMs) * 0.001f;  // in seconds
-
-    std::cout << "calculateOnsetwiseTimbreSpace end:   " << endTimeStr << "\n";
-    std::cout << "\t\t\t Elapsed time:   " << juce::String (elapsed, 3) << " seconds\n";
-
     return timbre_points;
 }
 
@@ -284,12 +384,12 @@ std::optional<vecVecReal> Analyzer::calculatePCA(const std::vector<FeatureContai
     if (allFeatures.size() < 2){	// can't perform PCA with 1 sample
         return std::nullopt;
     }
-    // gather desired features into vecVecReal
-    vecVecReal V;
-    V.reserve(allFeatures.size());
+    // gather desired features into one events x features matrix
+    FeatureMatrix<Real> V(featuresToUse.size());
+    V.reserveRows(allFeatures.size());
 
     for (const auto &f : allFeatures){
-        V.push_back(extractFeatures(f, featuresToUse, statToUse));
+        extractFeatures(f, featuresToUse, statToUse, V.appendRow());
     }
 
     vecVecReal pca = PCA(V, 6);
@@ -9,6 +9,7 @@
 */
 
 #pragma once
+#include <mutex>
 #include <optional>
 
 #include <juce_core/juce_core.h>
@@ -19,6 +20,8 @@
 #include "Features.h"
 #include "Statistics.h"
 #include "Settings.h"
+#include "AnalysisScheduler.h"
+#include "OnsetAnalysis/OnsetAnalysis.h"
 
 
 namespace nvs::analysis {
@@ -76,32 +79,52 @@ extractFeatures(const FeatureContainer<T> & allFeatures,
 	return v;
 }
 
-[[nodiscard]]
-inline vecReal
-extractFeatures(FeatureContainer<EventwiseStatistics<Real>> const & allFeatures,
-				const std::vector<Feature_e> &featuresToUse,
-				const Statistic statisticToUse)
-{
-	const auto descriptions = extractFeatures(allFeatures, featuresToUse);
-	Real EventwiseStatistics<Real>::* ptr = nullptr;
+inline Real EventwiseStatistics<Real>::* statisticMember(const Statistic statisticToUse) {
 	switch (statisticToUse) {
-		case Statistic::Mean:     ptr = &EventwiseStatistics<Real>::mean;    	break;
-		case Statistic::Median:   ptr = &EventwiseStatistics<Real>::median;  	break;
-		case Statistic::Variance: ptr = &EventwiseStatistics<Real>::variance;	break;
-		case Statistic::Skewness: ptr = &EventwiseStatistics<Real>::skewness;	break;
-		case Statistic::Kurtosis: ptr = &EventwiseStatistics<Real>::kurtosis;	break;
+		case Statistic::Mean:     return &EventwiseStatistics<Real>::mean;
+		case Statistic::Median:   return &EventwiseStatistics<Real>::median;
+		case Statistic::Variance: return &EventwiseStatistics<Real>::variance;
+		case Statistic::Skewness: return &EventwiseStatistics<Real>::skewness;
+		case Statistic::Kurtosis: return &EventwiseStatistics<Real>::kurtosis;
 	    case Statistic::NumStatistics: jassertfalse; break;
 		default: jassertfalse;
 	}
+	return nullptr;
+}
 
-	std::vector<Real> out;
-	out.reserve(descriptions.size());
-	for (auto const & d : descriptions) {
-		out.push_back(d.*ptr);
+// writes the chosen statistic of each of featuresToUse into out (e.g. a row of a FeatureMatrix), without allocating
+inline void
+extractFeatures(FeatureContainer<EventwiseStatistics<Real>> const & allFeatures,
+				const std::vector<Feature_e> &featuresToUse,
+				const Statistic statisticToUse,
+				std::span<Real> out)
+{
+	jassert (out.size() == featuresToUse.size());
+	Real EventwiseStatistics<Real>::* ptr = statisticMember(statisticToUse);
+	for (size_t i = 0; i < featuresToUse.size(); ++i) {
+		out[i] = allFeatures[featuresToUse[i]].*ptr;
 	}
+}
+
+[[nodiscard]]
+inline vecReal
+extractFeatures(FeatureContainer<EventwiseStatistics<Real>> const & allFeatures,
+				const std::vector<Feature_e> &featuresToUse,
+				const Statistic statisticToUse)
+{
+	std::vector<Real> out(featuresToUse.size());
+	extractFeatures(allFeatures, featuresToUse, statisticToUse, out);
 	return out;
 }
 
+// identifies the inputs of each analysis stage, so that a stage only needs rerunning when its key changes.
+// keys are built from the hashes of the settings branches (or the individual values) each stage depends on.
+struct StageKeys {
+	juce::String onsetDetection;	// the 5 x N onset detection function matrix
+	juce::String onsetPicking;		// onsets picked from that matrix (or laid out uniformly)
+	juce::String eventDescription;	// the eventwise timbre, pitch and loudness of any one event
+};
+
 class Analyzer {
 private:
 	nvs::ess::EssentiaInitializer ess_init;	  // this MUST be initialized before EssentiaHolder.
@@ -114,10 +137,19 @@ public:
         vecReal const &wave,
         RunLoopStatus& rls,
 	    const ShouldExitFn &shouldExit) const;
+	// the stages of calculateOnsetsInSeconds, so that their results can be kept and reused separately.
+	// calculateOnsetDetectionMatrix returns nullopt if it was stopped early.
+	std::optional<array2dReal> calculateOnsetDetectionMatrix(vecReal const &wave, RunLoopStatus& rls,
+															 const ShouldExitFn &shouldExit) const;
+	vecReal pickOnsets(array2dReal const &onsetDetectionMatrix) const;
+	vecReal calculateUniformOnsets(size_t waveLength) const;
 
 	void calculateEventwisePitchDescription(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features) const;
 	void calculateEventwiseTimbreDescription(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features) const;
 	void calculateEventwiseLoudness(vecReal const &waveEvent, FeatureContainer<EventwiseStats> &features) const;
+	// timbre, pitch and loudness from a single framing of the event (see EventFramePipeline).
+	// waveEvent is an unfaded view into the analyzed wave; fades are applied as frames are cut.
+	void calculateEventwiseDescription(std::span<Real const> waveEvent, FeatureContainer<EventwiseStats> &features) const;
 
 	std::optional<std::vector<FeatureContainer<EventwiseStats>>>
     calculateOnsetwiseTimbreSpace(
@@ -125,6 +157,25 @@ public:
         const vecReal &onsetsInSeconds,
         RunLoopStatus& rls,
         const ShouldExitFn &shouldExit) const;
+	// as below, on the Analyzer's own scheduler
+	std::optional<std::vector<FeatureContainer<EventwiseStats>>>
+	calculateEventwiseDescriptions(
+		const vecReal &wave,
+		std::span<EventView const> events,
+		RunLoopStatus& rls,
+		const ShouldExitFn &shouldExit,
+		AnalysisScheduler::BatchStats *batchStats = nullptr) const;
+	// describes every event on the given scheduler, in chunks of consecutive events sized by sample count.
+	// chunks are run longest-first, so a long event near the end of the file can't leave the other workers idle.
+	// if batchStats is given, it receives the scheduler's per-worker busy time for this run.
+	std::optional<std::vector<FeatureContainer<EventwiseStats>>>
+	calculateEventwiseDescriptions(
+		AnalysisScheduler &scheduler,
+		const vecReal &wave,
+		std::span<EventView const> events,
+		RunLoopStatus& rls,
+		const ShouldExitFn &shouldExit,
+		AnalysisScheduler::BatchStats *batchStats = nullptr) const;
 
     static std::optional<vecVecReal> calculatePCA(
 	    const std::vector<FeatureContainer<EventwiseStats>> &allFeatures,
@@ -135,15 +186,32 @@ public:
 
 	bool updateSettings(juce::ValueTree &newSettings, bool attemptFix);
 	AnalyzerSettings const &getSettings() const;
+    // of the whole settings tree but numThreads, which doesn't change results
     juce::String getSettingsHash() const {
         return _settingsHash;
     }
+	// hash of one settings branch (e.g. axiom::tsn::BFCC); the Analysis branch's hash leaves out numThreads
+	juce::String getBranchHash(const juce::String &branchName) const;
+	StageKeys const &getStageKeys() const { return _stageKeys; }
+	// runs on the given scheduler (e.g. one shared by several analyzers) whatever analysis.numThreads says;
+	// nullptr goes back to one of its own
+	void setScheduler(std::shared_ptr<AnalysisScheduler> scheduler);
 
     //====================================================================================
 	nvs::ess::EssentiaHolder ess_hold;
 private:
 	AnalyzerSettings settings;
     juce::String _settingsHash {};
+	std::map<juce::String, juce::String> _branchHashes;
+	StageKeys _stageKeys;
+	// persistent workers for the eventwise stage, started on first use (so analyzers are cheap to create) and rebuilt
+	// only when analysis.numThreads changes. a scheduler given to setScheduler is kept as it is
+	mutable std::shared_ptr<AnalysisScheduler> _scheduler;
+	bool _schedulerIsShared {false};
+	mutable std::mutex _schedulerMutex;
+	AnalysisScheduler &getScheduler() const;
+
+	void updateStageKeys(const juce::ValueTree &settingsTree);
 };
 
 double getLengthInSeconds(auto lengthInSamples, auto sampleRate){
@@ -160,13 +228,16 @@ concept StatisticVectorFunction = requires(Func f, vecReal const &v) {
 	{ f(v) } -> std::convertible_to<Real>;
 };
 
-template <StatisticVectorFunction Func>
-vecReal binwiseStatistic(vecVecReal const &V, Func statisticFunc) {
-	vecVecReal Vtranspose = transpose(V);
-	size_t const sz = Vtranspose.size();
+// applies statisticFunc to each column (bin) of V. each column is gathered into one reused buffer, so no transpose.
+template <StatisticVectorFunction Func, MatrixLayout Layout>
+vecReal binwiseStatistic(FeatureMatrix<Real, Layout> const &V, Func statisticFunc) {
+	size_t const sz = V.numColumns();
 	vecReal results(sz);
+	vecReal bin(V.numRows());
 	for (size_t i = 0; i < sz; ++i) {
-		results[i] = statisticFunc(Vtranspose[i]);
+		const auto column = V.column(i);
+		std::copy(column.begin(), column.end(), bin.begin());
+		results[i] = statisticFunc(bin);
 	}
 	return results;
 }
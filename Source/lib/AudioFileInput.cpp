@@ -0,0 +1,53 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "AudioFileInput.h"
+#include "MappedAudioFile.h"
+
+namespace nvs::analysis {
+
+std::unique_ptr<juce::AudioFormatReader> createAudioFileReader(const juce::File &file) {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    auto reader = std::unique_ptr<juce::AudioFormatReader>( formatManager.createReaderFor(file));
+    if (reader == nullptr) {
+        DBG("Failed to open file " + file.getFileName());
+    }
+    return reader;
+}
+
+AudioFileInfo readIntoWave(vecReal &wave, const juce::File &file) {
+    const auto mapped = MappedAudioFile::open(file);
+    const auto openedReader = mapped == nullptr ? createAudioFileReader(file) : nullptr;
+    juce::AudioFormatReader *reader = mapped != nullptr ? &mapped->getReader() : openedReader.get();
+    if (reader == nullptr) {
+        return {};
+    }
+
+    const auto numSamps = reader->lengthInSamples;
+    if (mapped != nullptr && !mapped->getFloatSamples().empty()) {
+        const auto samples = mapped->getFloatSamples();
+        wave.assign(samples.begin(), samples.end());
+    } else {
+        wave.resize(static_cast<size_t>(numSamps));
+        constexpr int chunkSize {1 << 16};
+        for (juce::int64 position = 0; position < numSamps; position += chunkSize) {
+            const auto n = static_cast<int>(std::min<juce::int64>(chunkSize, numSamps - position));
+            float *dest = wave.data() + position;
+            if (!reader->read(&dest, 1, position, n)) {
+                DBG("Failed to read " + file.getFileName() + " at sample " + juce::String{position});
+                wave.clear();
+                return {};
+            }
+        }
+    }
+
+    return {
+        .numSamples = static_cast<juce::int64>(wave.size()),
+        .sampleRate = reader->sampleRate,
+        .bitDepth = reader->bitsPerSample
+    };
+}
+
+}   // namespace nvs::analysis
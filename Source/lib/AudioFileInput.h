@@ -0,0 +1,27 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <memory>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "AnalysisUsing.h"
+
+namespace nvs::analysis {
+
+struct AudioFileInfo {
+    juce::int64 numSamples {0};
+    double sampleRate {0.0};
+    unsigned int bitDepth {0};
+};
+
+// a reader for any of JUCE's basic formats; nullptr if the file could not be opened
+std::unique_ptr<juce::AudioFormatReader> createAudioFileReader(const juce::File &file);
+
+// decodes the first channel straight into the wave, a chunk at a time, so there is no intermediate whole-file buffer
+// and no limit of INT_MAX samples. uncompressed files are read through a memory mapping, and mono float ones copied
+// from it directly. numSamples is 0 if the file could not be read.
+AudioFileInfo readIntoWave(vecReal &wave, const juce::File &file);
+
+}   // namespace nvs::analysis
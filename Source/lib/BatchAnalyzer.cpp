@@ -0,0 +1,224 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "BatchAnalyzer.h"
+#include "AnalysisResultFile.h"
+#include "StringAxiom.h"
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace nvs::analysis {
+
+namespace {
+
+// about as much audio as a worker describes before splitting it further stops paying for the coordination
+constexpr double secondsOfAudioPerThread {10.0};
+constexpr int exitCheckIntervalMs {100};
+constexpr size_t maxFilesDecodedAhead {2};
+
+struct DecodedFile {
+    juce::File file;
+    vecReal wave;
+    AudioFileInfo info;
+    juce::uint64 ticket {0};   // the file's place in line for threads
+};
+
+// threads shared by the files in flight, handed out strictly in file order so a long file is not starved by short ones
+class ThreadBudget {
+public:
+    explicit ThreadBudget(const size_t numThreads) : _available(numThreads) {}
+
+    void acquire(const juce::uint64 ticket, const size_t numThreads) {
+        std::unique_lock lock(_mutex);
+        _cv.wait(lock, [&] { return _serving == ticket && _available >= numThreads; });
+        _available -= numThreads;
+        ++_serving;
+        _cv.notify_all();
+    }
+    void release(const size_t numThreads) {
+        {
+            std::lock_guard lock(_mutex);
+            _available += numThreads;
+        }
+        _cv.notify_all();
+    }
+private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    size_t _available;
+    juce::uint64 _serving {0};
+};
+
+}   // anonymous namespace
+
+BatchAnalyzer::BatchAnalyzer(AnalyzerSettings baseSettings, const size_t numThreads)
+:   _baseSettings(std::move(baseSettings))
+,   _numThreads(std::max<size_t>(numThreads, 1))
+,   _scheduler(std::make_shared<AnalysisScheduler>(_numThreads))
+{
+    for (size_t i = 0; i < _numThreads; ++i) {
+        _lanes.push_back(std::make_unique<ThreadedAnalyzer>());
+        _lanes.back()->getAnalyzer().setScheduler(_scheduler);
+    }
+}
+
+BatchAnalyzer::~BatchAnalyzer() = default;
+
+void BatchAnalyzer::setCache(std::shared_ptr<AnalysisCache> const &cache) {
+    for (auto &analyzer : _lanes) {
+        analyzer->setCache(cache);
+    }
+}
+
+size_t BatchAnalyzer::getNumThreadsFor(AudioFileInfo const &info) const {
+    const double seconds = static_cast<double>(info.numSamples) / std::max(info.sampleRate, 1.0);
+    const auto wanted = static_cast<size_t>(std::ceil(seconds / secondsOfAudioPerThread));
+    return std::clamp<size_t>(wanted, 1, _numThreads);
+}
+
+auto BatchAnalyzer::run(std::vector<juce::File> const &files, FileCallback onFileDone, const ShouldExitFn &shouldExit)
+-> Stats
+{
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    if (_outputDirectory != juce::File{}) {
+        _outputDirectory.createDirectory();
+    }
+    Stats stats;
+    std::mutex resultMutex;
+    const auto report = [&](FileResult const &result) {
+        std::lock_guard lock(resultMutex);
+        ++stats.numFiles;
+        if (result.succeeded) {
+            stats.numEvents += result.numEvents;
+            stats.audioSeconds += static_cast<double>(result.numSamples) / std::max(result.sampleRate, 1.0);
+        } else {
+            ++stats.numFailed;
+        }
+        if (onFileDone) {
+            onFileDone(result);
+        }
+    };
+
+    // decoded files waiting for a lane: enough that a lane finishing finds its next file ready, few enough that memory
+    // is bounded by the files in flight rather than the corpus
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::deque<DecodedFile> queue;
+    bool decodingFinished {false};
+    std::atomic<bool> stop {false};
+    juce::uint64 nextTicket {0};
+    ThreadBudget budget(_numThreads);
+    const auto requestStop = [&] {
+        std::lock_guard lock(queueMutex);
+        stop.store(true);
+        queueCv.notify_all();
+    };
+
+    std::thread decoder([&] {
+        for (auto const &file : files) {
+            DecodedFile decoded;
+            decoded.file = file;
+            decoded.info = readIntoWave(decoded.wave, file);
+            if (decoded.info.numSamples == 0) {
+                report(FileResult{ .file = file });
+                continue;
+            }
+            std::unique_lock lock(queueMutex);
+            queueCv.wait(lock, [&] { return queue.size() < maxFilesDecodedAhead || stop.load(); });
+            if (stop.load()) {
+                break;
+            }
+            queue.push_back(std::move(decoded));
+            queueCv.notify_all();
+        }
+        std::lock_guard lock(queueMutex);
+        decodingFinished = true;
+        queueCv.notify_all();
+    });
+
+    const auto runLane = [&](ThreadedAnalyzer &analyzer) {
+        while (!stop.load()) {
+            DecodedFile decoded;
+            {
+                std::unique_lock lock(queueMutex);
+                queueCv.wait(lock, [&] { return !queue.empty() || decodingFinished || stop.load(); });
+                if (queue.empty() || stop.load()) {
+                    return;
+                }
+                decoded = std::move(queue.front());
+                queue.pop_front();
+                decoded.ticket = nextTicket++;      // taken with the file, so threads are granted in file order
+                queueCv.notify_all();
+            }
+
+            FileResult result {
+                .file = decoded.file,
+                .numSamples = decoded.info.numSamples,
+                .sampleRate = decoded.info.sampleRate,
+                .numThreads = getNumThreadsFor(decoded.info)
+            };
+            budget.acquire(decoded.ticket, result.numThreads);
+            const double fileStartMs = juce::Time::getMillisecondCounterHiRes();
+
+            auto settings = _baseSettings;
+            settings.analysis.sampleRate = decoded.info.sampleRate;
+            // the file's share of the budget; it runs on the lanes' shared scheduler either way, so this only decides
+            // whether onset detection is split into chunks
+            settings.analysis.numThreads = static_cast<int>(result.numThreads);
+            settings.info.sampleFilePath = decoded.file.getFullPathName();
+            auto settingsParentTree = createParentTreeFromSettings(settings);
+            auto settingsTree = settingsParentTree.getChildWithName(axiom::tsn::Settings);
+            analyzer.updateStoredAudio(std::move(decoded.wave), settings.info.sampleFilePath);
+            analyzer.updateSettings(settingsTree, true);
+
+            if (analyzer.startThread(juce::Thread::Priority::normal)) {
+                while (!analyzer.waitForThreadToExit(exitCheckIntervalMs)) {
+                    if (shouldExit()) {
+                        requestStop();
+                        analyzer.stopAnalysis();
+                    }
+                }
+                if (auto timbre = analyzer.stealTimbreSpaceRepresentation(); timbre.has_value()) {
+                    result.succeeded = true;
+                    result.numEvents = timbre->timbreMeasurements.size();
+                    if (_outputDirectory != juce::File{}) {
+                        // the hash keeps same-named files from different directories apart
+                        const auto outputFile = _outputDirectory.getChildFile(decoded.file.getFileNameWithoutExtension()
+                            + "_" + timbre->waveformHash.substring(0, 12) + AnalysisResultFile::fileExtension);
+                        const auto onsets = analyzer.shareOnsetAnalysis();
+                        result.succeeded = onsets != nullptr
+                            && AnalysisResultFile::write(outputFile, *onsets, *timbre, analyzer.getSettingsHash(),
+                                                         decoded.info.sampleRate);
+                    }
+                }
+            }
+            analyzer.updateStoredAudio(vecReal{}, {});     // don't hold the wave until this lane's next file
+            budget.release(result.numThreads);
+
+            result.seconds = (juce::Time::getMillisecondCounterHiRes() - fileStartMs) / 1000.0;
+            if (!stop.load()) {
+                report(result);
+            }
+        }
+    };
+
+    std::vector<std::thread> lanes;
+    for (auto &analyzer : _lanes) {
+        lanes.emplace_back(runLane, std::ref(*analyzer));
+    }
+    for (auto &lane : lanes) {
+        lane.join();
+    }
+    requestStop();     // the lanes are done, so the decoder is either finished or has nothing left to decode for
+    decoder.join();
+
+    stats.seconds = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+    return stats;
+}
+
+}   // namespace nvs::analysis
@@ -0,0 +1,68 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "AudioFileInput.h"
+#include "ThreadedAnalyzer.h"
+
+namespace nvs::analysis {
+
+/**
+ * Analyzes a corpus of files as a pipeline: one thread decodes the files in order, a few ahead of the analysis, while
+ * several files are analyzed at once. Each file is given worker threads in proportion to its length, drawn from a
+ * shared budget of numThreads: a short sample, whose few events cannot occupy many cores, runs on one thread beside
+ * others, while a long recording gets all of them. Files start in order, each once the budget has its threads free.
+ * Every lane runs on one scheduler of numThreads workers, started once, so the budget alone limits concurrency and no
+ * threads are started or stopped between files.
+ */
+class BatchAnalyzer {
+public:
+    struct FileResult {
+        juce::File file;
+        bool succeeded {false};
+        juce::int64 numSamples {0};
+        double sampleRate {0.0};
+        size_t numEvents {0};
+        size_t numThreads {0};      // that analyzed it
+        double seconds {0.0};       // analysis, not decoding
+    };
+    struct Stats {
+        size_t numFiles {0};
+        size_t numFailed {0};
+        size_t numEvents {0};
+        double audioSeconds {0.0};
+        double seconds {0.0};
+        double filesPerSecond() const { return seconds > 0.0 ? static_cast<double>(numFiles) / seconds : 0.0; }
+        double realtimeFactor() const { return seconds > 0.0 ? audioSeconds / seconds : 0.0; }
+    };
+    // called from the analysis threads, one call at a time
+    using FileCallback = std::function<void(FileResult const &)>;
+
+    // baseSettings is applied to every file, with its sample rate, path and thread count filled in per file
+    BatchAnalyzer(AnalyzerSettings baseSettings, size_t numThreads);
+    ~BatchAnalyzer();
+
+    // if set, each file's results are written there as an AnalysisResultFile, named after the file and its audio hash
+    void setOutputDirectory(juce::File directory) { _outputDirectory = std::move(directory); }
+    // every file's results are looked up in and stored to this cache (see ThreadedAnalyzer::setCache); off by default
+    void setCache(std::shared_ptr<AnalysisCache> const &cache);
+
+    Stats run(std::vector<juce::File> const &files, FileCallback onFileDone, const ShouldExitFn &shouldExit);
+
+private:
+    AnalyzerSettings _baseSettings;
+    size_t _numThreads;
+    juce::File _outputDirectory;
+    // one analyzer per file in flight, created up front (Essentia's factories are not safe to initialize concurrently)
+    std::vector<std::unique_ptr<ThreadedAnalyzer>> _lanes;
+    std::shared_ptr<AnalysisScheduler> _scheduler;    // shared by the lanes
+
+    size_t getNumThreadsFor(AudioFileInfo const &info) const;
+};
+
+}   // namespace nvs::analysis
@@ -0,0 +1,1258 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "Benchmarks.h"
+#include <array>
+#include <cstring>
+#include <limits>
+#include <thread>
+#if ! JUCE_WINDOWS
+ #include <sys/resource.h>
+#endif
+#include "AnalysisResultFile.h"
+#include "LiveAnalyzer.h"
+#include "MappedAudioFile.h"
+#include "OnsetAnalysis/OnsetAnalysis.h"
+#include "OnsetAnalysis/OnsetProcessing.h"
+#include "StringAxiom.h"
+#include "TimbreAnalysis/EventFramePipeline.h"
+#include "TimbreAnalysis/FastYin.h"
+#include "TimbreAnalysis/ProbabilisticYin.h"
+#include "TimbreAnalysis/ChromaPitch.h"
+#include "TimbreAnalysis/SpectralDescriptors.h"
+#include "TimbreAnalysis/BatchBFCC.h"
+#include "SpectralFrontEnd.h"
+
+namespace nvs::analysis::benchmark {
+
+namespace {
+
+struct Stopwatch {
+    double startMs {juce::Time::getMillisecondCounterHiRes()};
+    double elapsedMs() const { return juce::Time::getMillisecondCounterHiRes() - startMs; }
+};
+
+const ShouldExitFn neverExit = [] { return false; };
+
+std::vector<float> benchmarkOnsets(Analyzer &analyzer, vecReal const &wave, RunLoopStatus &rls) {
+    auto onsets = analyzer.calculateOnsetsInSeconds(wave, rls, neverExit).value_or(vecReal{});
+    const auto lengthInSeconds = getLengthInSeconds(wave.size(), analyzer.getAnalyzedFileSampleRate());
+    filterOnsets(onsets, lengthInSeconds);
+    forceMinimumOnsets(onsets, 4, lengthInSeconds);
+    return onsets;
+}
+
+Real maxAbsMeanDifference(FeatureContainer<Analyzer::EventwiseStats> const &a,
+                          FeatureContainer<Analyzer::EventwiseStats> const &b) {
+    Real maxDiff {0.f};
+    for (size_t i = 0; i < a.features.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(a.features[i].mean - b.features[i].mean));
+    }
+    return maxDiff;
+}
+
+// compares running timbre, pitch and loudness separately per event (each framing the event itself)
+// against the shared single-pass EventFramePipeline
+void benchmarkEventFraming(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto onsets = benchmarkOnsets(analyzer, wave, rls);
+    const vecVecReal events = splitWaveIntoEvents(wave, onsets, analyzer.ess_hold.factory, analyzer.getSettings(),
+                                                  rls, neverExit);
+    if (events.empty()) {
+        std::cerr << "eventFraming: no events\n";
+        return;
+    }
+
+    const auto views = calculateEventViews(wave.size(), onsets, analyzer.getSettings());
+    jassert (views.size() == events.size());
+
+    std::vector<FeatureContainer<Analyzer::EventwiseStats>> separate(events.size()), shared(events.size());
+
+    const Stopwatch separateTimer;
+    for (size_t i = 0; i < events.size(); ++i) {
+        analyzer.calculateEventwiseTimbreDescription(events[i], separate[i]);
+        analyzer.calculateEventwisePitchDescription(events[i], separate[i]);
+        analyzer.calculateEventwiseLoudness(events[i], separate[i]);
+    }
+    const double separateMs = separateTimer.elapsedMs();
+
+    const Stopwatch sharedTimer;
+    for (size_t i = 0; i < events.size(); ++i) {
+        analyzer.calculateEventwiseDescription(views[i].of(wave), shared[i]);
+    }
+    const double sharedMs = sharedTimer.elapsedMs();
+
+    Real maxDiff {0.f};
+    for (size_t i = 0; i < events.size(); ++i) {
+        maxDiff = std::max(maxDiff, maxAbsMeanDifference(separate[i], shared[i]));
+    }
+
+    const auto numEvents = static_cast<double>(events.size());
+    std::cout << "eventFraming: " << events.size() << " events\n"
+              << "\tseparate passes: " << juce::String(separateMs, 2) << " ms ("
+              << juce::String(1000.0 * separateMs / numEvents, 2) << " us/event)\n"
+              << "\tshared pipeline: " << juce::String(sharedMs, 2) << " ms ("
+              << juce::String(1000.0 * sharedMs / numEvents, 2) << " us/event)\n"
+              << "\tsaved per event: " << juce::String(1000.0 * (separateMs - sharedMs) / numEvents, 2) << " us"
+              << " (speedup " << juce::String(separateMs / std::max(sharedMs, 1e-9), 2) << "x)\n"
+              << "\tmax |mean difference|: " << maxDiff << "\n";
+}
+
+// creating every algorithm for each event vs. the per-thread cached pipeline
+void benchmarkAlgorithmCache(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto onsets = benchmarkOnsets(analyzer, wave, rls);
+    const auto &settings = analyzer.getSettings();
+    const auto events = calculateEventViews(wave.size(), onsets, settings);
+
+    const Stopwatch freshTimer;
+    for (auto const &e : events) {
+        EventFramePipeline pipeline(settings);
+        [[maybe_unused]] const auto frames = pipeline.process(e.of(wave));
+    }
+    const double freshMs = freshTimer.elapsedMs();
+
+    const Stopwatch cachedTimer;
+    for (auto const &e : events) {
+        auto &pipeline = EventFramePipeline::getForCurrentThread(settings, analyzer.getSettingsHash());
+        [[maybe_unused]] const auto frames = pipeline.process(e.of(wave));
+    }
+    const double cachedMs = cachedTimer.elapsedMs();
+
+    const auto numEvents = static_cast<double>(events.size());
+    std::cout << "algorithmCache: " << events.size() << " events\n"
+              << "\tcreated per event: " << juce::String(1000.0 * freshMs / numEvents, 2) << " us/event\n"
+              << "\tcached per thread: " << juce::String(1000.0 * cachedMs / numEvents, 2) << " us/event\n";
+}
+
+// describing events with every feature vs. only what a PCA over BFCC means needs, and vs. timbre without pitch or
+// loudness. the requested statistics must match the full pipeline's exactly
+void benchmarkFeatureSubset(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto onsets = benchmarkOnsets(analyzer, wave, rls);
+    const auto &settings = analyzer.getSettings();
+    const auto events = calculateEventViews(wave.size(), onsets, settings);
+    if (events.empty()) {
+        std::cerr << "featureSubset: no events\n";
+        return;
+    }
+
+    const auto describeAll = [&events, &wave](AnalyzerSettings const &subsetSettings, double &ms) {
+        EventFramePipeline pipeline(subsetSettings);
+        std::vector<FeatureContainer<Analyzer::EventwiseStats>> described;
+        described.reserve(events.size());
+        const Stopwatch timer;
+        for (auto const &e : events) {
+            described.push_back(pipeline.process(e.of(wave)));
+        }
+        ms = timer.elapsedMs();
+        return described;
+    };
+
+    auto bfccMeans = settings;
+    bfccMeans.request.features.reset();
+    for (const auto f : bfccSet) {
+        bfccMeans.request.features.set(static_cast<size_t>(f));
+    }
+    bfccMeans.request.statistics.reset();
+    bfccMeans.request.statistics.set(static_cast<size_t>(Statistic::Mean));
+
+    auto timbreOnly = settings;
+    timbreOnly.request.features.reset(static_cast<size_t>(Feature_e::f0));
+    timbreOnly.request.features.reset(static_cast<size_t>(Feature_e::Periodicity));
+    timbreOnly.request.features.reset(static_cast<size_t>(Feature_e::Loudness));
+
+    double fullMs {0.0}, bfccMeansMs {0.0}, timbreOnlyMs {0.0};
+    auto full = settings;
+    full.request = {};
+    const auto fullResults = describeAll(full, fullMs);
+    const auto bfccMeansResults = describeAll(bfccMeans, bfccMeansMs);
+    const auto timbreOnlyResults = describeAll(timbreOnly, timbreOnlyMs);
+
+    Real maxDiff {0.f};
+    for (size_t i = 0; i < events.size(); ++i) {
+        for (const auto f : bfccSet) {
+            maxDiff = std::max(maxDiff, std::abs(fullResults[i][f].mean - bfccMeansResults[i][f].mean));
+        }
+        for (int f = 0; f < NumTimbralFeatures; ++f) {
+            auto const &a = fullResults[i].features[static_cast<size_t>(f)];
+            auto const &b = timbreOnlyResults[i].features[static_cast<size_t>(f)];
+            maxDiff = std::max({ maxDiff, std::abs(a.mean - b.mean), std::abs(a.median - b.median),
+                                 std::abs(a.variance - b.variance) });
+        }
+    }
+
+    const auto numEvents = static_cast<double>(events.size());
+    const auto perEvent = [numEvents](const double ms) { return juce::String(1000.0 * ms / numEvents, 2) + " us/event"; };
+    std::cout << "featureSubset: " << events.size() << " events\n"
+              << "\tall features:             " << perEvent(fullMs) << "\n"
+              << "\tBFCC means:               " << perEvent(bfccMeansMs)
+              << " (speedup " << juce::String(fullMs / std::max(bfccMeansMs, 1e-9), 2) << "x)\n"
+              << "\tno pitch or loudness:     " << perEvent(timbreOnlyMs)
+              << " (speedup " << juce::String(fullMs / std::max(timbreOnlyMs, 1e-9), 2) << "x)\n"
+              << "\tmax |requested difference|: " << maxDiff << "\n";
+}
+
+// PitchYin vs. FastYin (yinFast) on the same windowed frames, at growing frame sizes (run it on audio/sweep.wav).
+// FastYin's time excludes the spectrum, which the pipeline shares with the timbre features; computing it is listed apart.
+// agreement is measured on the frames PitchYin is confident about
+void benchmarkFastYin(Analyzer &analyzer, vecReal const &wave) {
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    std::cout << "fastYin: " << wave.size() << " samples\n";
+    for (const int frameSize : {1024, 2048, 4096, 8192}) {
+        AnalyzerSettings settings = analyzer.getSettings();
+        settings.analysis.frameSize = frameSize;
+        settings.bfcc.spectrumType = axiom::tsn::power;
+        const auto windowing = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Windowing",
+            "normalized", false, "size", frameSize, "zeroPadding", frameSize,
+            "type", settings.analysis.windowingType.toStdString(), "zeroPhase", false));
+        const auto spectrum = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("PowerSpectrum",
+            "size", frameSize * 2));
+        const auto pitchYin = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("PitchYin",
+            "frameSize", frameSize, "interpolate", settings.pitch.interpolate,
+            "maxFrequency", settings.pitch.maxFrequency, "minFrequency", settings.pitch.minFrequency,
+            "sampleRate", settings.analysis.sampleRate, "tolerance", settings.pitch.tolerance));
+        FastYin fastYin(settings);
+
+        double windowingMs {0.0}, spectrumMs {0.0}, pitchYinMs {0.0}, fastYinMs {0.0};
+        std::vector<double> centsDifferences;
+        size_t numFrames {0};
+        vecReal frame, windowedFrame, powerSpectrum;
+        for (size_t start = 0; start + static_cast<size_t>(frameSize) <= wave.size(); start += static_cast<size_t>(frameSize / 2)) {
+            frame.assign(wave.begin() + static_cast<std::ptrdiff_t>(start),
+                         wave.begin() + static_cast<std::ptrdiff_t>(start) + frameSize);
+            const Stopwatch windowingTimer;
+            windowing->input("frame").set(frame);
+            windowing->output("frame").set(windowedFrame);
+            windowing->compute();
+            windowingMs += windowingTimer.elapsedMs();
+
+            const Stopwatch spectrumTimer;
+            spectrum->input("signal").set(windowedFrame);
+            spectrum->output("powerSpectrum").set(powerSpectrum);
+            spectrum->compute();
+            spectrumMs += spectrumTimer.elapsedMs();
+
+            Real pitch, confidence;
+            const Stopwatch pitchYinTimer;
+            pitchYin->input("signal").set(windowedFrame);
+            pitchYin->output("pitch").set(pitch);
+            pitchYin->output("pitchConfidence").set(confidence);
+            pitchYin->compute();
+            pitchYinMs += pitchYinTimer.elapsedMs();
+
+            const Stopwatch fastYinTimer;
+            const auto estimate = fastYin.compute(windowedFrame, powerSpectrum);
+            fastYinMs += fastYinTimer.elapsedMs();
+
+            ++numFrames;
+            if (confidence >= 0.5f && pitch > 0.f && estimate.frequency > 0.f) {
+                centsDifferences.push_back(std::abs(1200.0 * std::log2(estimate.frequency / pitch)));
+            }
+        }
+        if (numFrames == 0) {
+            std::cout << "\tframe size " << frameSize << ": file too short\n";
+            continue;
+        }
+        std::sort(centsDifferences.begin(), centsDifferences.end());
+        const auto within50 = std::count_if(centsDifferences.begin(), centsDifferences.end(), [](const double c) { return c < 50.0; });
+        const auto perFrame = [numFrames](const double ms) { return juce::String(1000.0 * ms / static_cast<double>(numFrames), 2) + " us/frame"; };
+        std::cout << "\tframe size " << frameSize << ", " << numFrames << " frames:\n"
+                  << "\t\tPitchYin: " << perFrame(pitchYinMs) << ", FastYin: " << perFrame(fastYinMs)
+                  << " (speedup " << juce::String(pitchYinMs / std::max(fastYinMs, 1e-9), 2) << "x; "
+                  << juce::String(pitchYinMs / std::max(fastYinMs + spectrumMs, 1e-9), 2) << "x if the spectrum is its own)\n"
+                  << "\t\twindowing: " << perFrame(windowingMs) << ", power spectrum: " << perFrame(spectrumMs) << "\n";
+        if (centsDifferences.empty()) {
+            std::cout << "\t\tno confidently pitched frames to compare\n";
+        } else {
+            std::cout << "\t\t" << centsDifferences.size() << " pitched frames: median |difference| "
+                      << juce::String(centsDifferences[centsDifferences.size() / 2], 2) << " cents, "
+                      << juce::String(100.0 * static_cast<double>(within50) / static_cast<double>(centsDifferences.size()), 1)
+                      << "% within 50 cents\n";
+        }
+    }
+}
+
+// throughput of each pitch backend at the analyzer's frame and hop size, on frames windowed and transformed once up
+// front (as the event pipeline shares them). pYin decodes in events of pYinEventFrames frames, Viterbi included.
+void benchmarkPitchBackends(Analyzer &analyzer, vecReal const &wave) {
+    constexpr size_t pYinEventFrames {256};
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    AnalyzerSettings settings = analyzer.getSettings();
+    settings.bfcc.spectrumType = axiom::tsn::power;
+    const int frameSize = settings.analysis.frameSize;
+    const auto hopSize = static_cast<size_t>(settings.analysis.hopSize);
+
+    const auto windowing = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Windowing",
+        "normalized", false, "size", frameSize, "zeroPadding", frameSize,
+        "type", settings.analysis.windowingType.toStdString(), "zeroPhase", false));
+    const auto spectrum = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("PowerSpectrum",
+        "size", frameSize * 2));
+    vecVecReal windowedFrames, spectra;
+    vecReal frame;
+    for (size_t start = 0; start + static_cast<size_t>(frameSize) <= wave.size(); start += hopSize) {
+        frame.assign(wave.begin() + static_cast<std::ptrdiff_t>(start),
+                     wave.begin() + static_cast<std::ptrdiff_t>(start) + frameSize);
+        windowing->input("frame").set(frame);
+        windowing->output("frame").set(windowedFrames.emplace_back());
+        windowing->compute();
+        spectrum->input("signal").set(windowedFrames.back());
+        spectrum->output("powerSpectrum").set(spectra.emplace_back());
+        spectrum->compute();
+    }
+    const size_t numFrames = windowedFrames.size();
+    if (numFrames == 0) {
+        std::cout << "pitchBackends: file too short\n";
+        return;
+    }
+
+    const auto pitchYin = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("PitchYin",
+        "frameSize", frameSize, "interpolate", settings.pitch.interpolate,
+        "maxFrequency", settings.pitch.maxFrequency, "minFrequency", settings.pitch.minFrequency,
+        "sampleRate", settings.analysis.sampleRate, "tolerance", settings.pitch.tolerance));
+    vecReal yinPitches(numFrames), yinConfidences(numFrames);
+    const Stopwatch pitchYinTimer;
+    for (size_t i = 0; i < numFrames; ++i) {
+        pitchYin->input("signal").set(windowedFrames[i]);
+        pitchYin->output("pitch").set(yinPitches[i]);
+        pitchYin->output("pitchConfidence").set(yinConfidences[i]);
+        pitchYin->compute();
+    }
+    const double pitchYinMs = pitchYinTimer.elapsedMs();
+
+    FastYin fastYin(settings);
+    const Stopwatch fastYinTimer;
+    for (size_t i = 0; i < numFrames; ++i) {
+        [[maybe_unused]] const auto estimate = fastYin.compute(windowedFrames[i], spectra[i]);
+    }
+    const double fastYinMs = fastYinTimer.elapsedMs();
+
+    ProbabilisticYin pYin(settings);
+    vecReal pYinFrequencies, eventFrequencies, eventVoicedProbabilities;
+    const Stopwatch pYinTimer;
+    for (size_t eventStart = 0; eventStart < numFrames; eventStart += pYinEventFrames) {
+        pYin.beginEvent();
+        for (size_t i = eventStart; i < std::min(eventStart + pYinEventFrames, numFrames); ++i) {
+            pYin.pushFrame(windowedFrames[i], spectra[i]);
+        }
+        pYin.endEvent(eventFrequencies, eventVoicedProbabilities);
+        pYinFrequencies.insert(pYinFrequencies.end(), eventFrequencies.begin(), eventFrequencies.end());
+    }
+    const double pYinMs = pYinTimer.elapsedMs();
+
+    ChromaPitch chroma(settings);
+    const Stopwatch chromaTimer;
+    for (size_t i = 0; i < numFrames; ++i) {
+        [[maybe_unused]] const auto estimate = chroma.compute(spectra[i]);
+    }
+    const double chromaMs = chromaTimer.elapsedMs();
+
+    // pYin against PitchYin where PitchYin is confident and pYin calls the frame voiced
+    std::vector<double> centsDifferences;
+    for (size_t i = 0; i < numFrames; ++i) {
+        if (yinConfidences[i] >= 0.5f && yinPitches[i] > 0.f && pYinFrequencies[i] > 0.f) {
+            centsDifferences.push_back(std::abs(1200.0 * std::log2(pYinFrequencies[i] / yinPitches[i])));
+        }
+    }
+    const auto framesPerSecond = [numFrames](const double ms) {
+        return juce::String(static_cast<double>(numFrames) / std::max(ms * 0.001, 1e-9), 0) + " frames/s";
+    };
+    std::cout << "pitchBackends: frame size " << frameSize << ", hop " << hopSize << ", " << numFrames << " frames\n"
+              << "\tPitchYin: " << framesPerSecond(pitchYinMs) << "\n"
+              << "\tyinFast:  " << framesPerSecond(fastYinMs) << "\n"
+              << "\tpYin:     " << framesPerSecond(pYinMs) << " (" << pYin.getNumPitchBins() << " pitch bins, events of "
+              << pYinEventFrames << " frames)\n"
+              << "\tchroma:   " << framesPerSecond(chromaMs) << "\n";
+    if (!centsDifferences.empty()) {
+        std::sort(centsDifferences.begin(), centsDifferences.end());
+        std::cout << "\tpYin vs. PitchYin on " << centsDifferences.size() << " confidently pitched frames: median |difference| "
+                  << juce::String(centsDifferences[centsDifferences.size() / 2], 2) << " cents\n";
+    }
+}
+
+// the fused SpectralDescriptors against the six Essentia algorithms it replaces, on the same spectra: time per frame,
+// and the largest difference of each descriptor relative to its magnitude
+void benchmarkSpectralDescriptors(Analyzer &analyzer, vecReal const &wave) {
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    AnalyzerSettings settings = analyzer.getSettings();
+    settings.request = {};
+    const int frameSize = settings.analysis.frameSize;
+    const auto hopSize = static_cast<size_t>(settings.analysis.hopSize);
+    const auto sampleRate = static_cast<float>(settings.analysis.sampleRate);
+    const bool isPower = (settings.bfcc.spectrumType == axiom::tsn::power);
+
+    const auto windowing = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Windowing",
+        "normalized", false, "size", frameSize, "zeroPadding", frameSize,
+        "type", settings.analysis.windowingType.toStdString(), "zeroPhase", false));
+    const auto spectrum = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create(
+        isPower ? "PowerSpectrum" : "Spectrum", "size", frameSize * 2));
+    vecVecReal spectra;
+    vecReal frame, windowedFrame;
+    for (size_t start = 0; start + static_cast<size_t>(frameSize) <= wave.size(); start += hopSize) {
+        frame.assign(wave.begin() + static_cast<std::ptrdiff_t>(start),
+                     wave.begin() + static_cast<std::ptrdiff_t>(start) + frameSize);
+        windowing->input("frame").set(frame);
+        windowing->output("frame").set(windowedFrame);
+        windowing->compute();
+        spectrum->input(isPower ? "signal" : "frame").set(windowedFrame);
+        spectrum->output(isPower ? "powerSpectrum" : "spectrum").set(spectra.emplace_back());
+        spectrum->compute();
+    }
+    if (spectra.empty()) {
+        std::cout << "spectralDescriptors: file too short\n";
+        return;
+    }
+
+    struct Descriptor {
+        Feature_e feature;
+        std::unique_ptr<essentia::standard::Algorithm> algorithm;
+        const char *input, *output;
+    };
+    std::array<Descriptor, 6> essentiaDescriptors {{
+        { Feature_e::SpectralCentroid, std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Centroid",
+            "range", sampleRate * 0.5f)), "array", "centroid" },
+        { Feature_e::SpectralDecrease, std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Decrease",
+            "range", sampleRate * 0.5f)), "array", "decrease" },
+        { Feature_e::SpectralFlatness, std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("FlatnessDB")),
+            "array", "flatnessDB" },
+        { Feature_e::SpectralCrest, std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Crest")),
+            "array", "crest" },
+        { Feature_e::SpectralComplexity, std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("SpectralComplexity",
+            "magnitudeThreshold", settings.spectralComplexity.magnitudeThreshold)),
+            "spectrum", "spectralComplexity" },
+        { Feature_e::StrongPeak, std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("StrongPeak")),
+            "spectrum", "strongPeak" }
+    }};
+
+    const size_t numFrames = spectra.size();
+    FeatureMatrix<Real> reference(NumTimbralFeatures), fused(NumTimbralFeatures);
+    reference.reserveRows(numFrames);
+    fused.reserveRows(numFrames);
+
+    const Stopwatch essentiaTimer;
+    for (auto const &s : spectra) {
+        const auto row = reference.appendRow();
+        for (auto &d : essentiaDescriptors) {
+            d.algorithm->input(d.input).set(s);
+            d.algorithm->output(d.output).set(row[static_cast<size_t>(d.feature)]);
+            d.algorithm->compute();
+        }
+    }
+    const double essentiaMs = essentiaTimer.elapsedMs();
+
+    const SpectralDescriptors descriptors(settings, static_cast<size_t>(frameSize) + 1);
+    const Stopwatch fusedTimer;
+    for (auto const &s : spectra) {
+        descriptors.compute(s, fused.appendRow());
+    }
+    const double fusedMs = fusedTimer.elapsedMs();
+
+    const auto perFrame = [numFrames](const double ms) { return juce::String(1000.0 * ms / static_cast<double>(numFrames), 2) + " us/frame"; };
+    std::cout << "spectralDescriptors: " << numFrames << " frames of " << frameSize + 1 << " bins\n"
+              << "\tEssentia x6: " << perFrame(essentiaMs) << ", fused: " << perFrame(fusedMs)
+              << " (speedup " << juce::String(essentiaMs / std::max(fusedMs, 1e-9), 2) << "x)\n";
+    for (auto const &d : essentiaDescriptors) {
+        const auto f = static_cast<size_t>(d.feature);
+        Real maxRelative {0.f};
+        for (size_t i = 0; i < numFrames; ++i) {
+            const Real expected = reference(i, f);
+            const Real difference = std::abs(fused(i, f) - expected);
+            maxRelative = std::max(maxRelative, difference / std::max(std::abs(expected), 1e-6f));
+        }
+        std::cout << "\t\t" << d.output << ": max relative difference " << juce::String(maxRelative, 6) << "\n";
+    }
+}
+
+// Essentia's BFCC frame by frame against BatchBFCC on blocks of frames, over the same spectra, at a few frame sizes:
+// time per frame, the one-off cost of building the tables, and the largest coefficient difference
+void benchmarkBatchBFCC(Analyzer &analyzer, vecReal const &wave) {
+    constexpr size_t blockFrames {64};
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    std::cout << "batchBFCC: " << wave.size() << " samples, blocks of " << blockFrames << " frames\n";
+    for (const int frameSize : {1024, 2048, 4096}) {
+        AnalyzerSettings settings = analyzer.getSettings();
+        settings.analysis.frameSize = frameSize;
+        settings.bfcc.numCoefficients = NumBFCC;   // so Essentia's rows line up with the timbre frames' columns
+        const bool isPower = (settings.bfcc.spectrumType == axiom::tsn::power);
+        const auto windowing = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Windowing",
+            "normalized", false, "size", frameSize, "zeroPadding", frameSize,
+            "type", settings.analysis.windowingType.toStdString(), "zeroPhase", false));
+        const auto spectrum = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create(
+            isPower ? "PowerSpectrum" : "Spectrum", "size", frameSize * 2));
+
+        FeatureMatrix<Real> spectra(static_cast<size_t>(frameSize) + 1);
+        vecReal frame, windowedFrame, spectrumVec;
+        for (size_t start = 0; start + static_cast<size_t>(frameSize) <= wave.size(); start += static_cast<size_t>(frameSize / 2)) {
+            frame.assign(wave.begin() + static_cast<std::ptrdiff_t>(start),
+                         wave.begin() + static_cast<std::ptrdiff_t>(start) + frameSize);
+            windowing->input("frame").set(frame);
+            windowing->output("frame").set(windowedFrame);
+            windowing->compute();
+            spectrum->input(isPower ? "signal" : "frame").set(windowedFrame);
+            spectrum->output(isPower ? "powerSpectrum" : "spectrum").set(spectrumVec);
+            spectrum->compute();
+            spectra.appendRow(spectrumVec);
+        }
+        const size_t numFrames = spectra.numRows();
+        if (numFrames == 0) {
+            std::cout << "\tframe size " << frameSize << ": file too short\n";
+            continue;
+        }
+
+        const auto essentiaBFCC = createEssentiaBFCC(settings);
+        FeatureMatrix<Real> reference(NumBFCC);
+        vecReal bands, bfccVec;
+        const Stopwatch essentiaTimer;
+        for (size_t i = 0; i < numFrames; ++i) {
+            const auto row = spectra.rowSpan(i);
+            spectrumVec.assign(row.begin(), row.end());
+            essentiaBFCC->input("spectrum").set(spectrumVec);
+            essentiaBFCC->output("bands").set(bands);
+            essentiaBFCC->output("bfcc").set(bfccVec);
+            essentiaBFCC->compute();
+            reference.appendRow(bfccVec);
+        }
+        const double essentiaMs = essentiaTimer.elapsedMs();
+
+        const Stopwatch tablesTimer;
+        BatchBFCC batchBFCC(settings);
+        const double tablesMs = tablesTimer.elapsedMs();
+
+        FeatureMatrix<Real> block(static_cast<size_t>(frameSize) + 1), batched(NumTimbralFeatures), blockRows(NumTimbralFeatures);
+        const Stopwatch batchTimer;
+        for (size_t start = 0; start < numFrames; start += blockFrames) {
+            block.clearRows();
+            blockRows.clearRows();
+            for (size_t i = start; i < std::min(start + blockFrames, numFrames); ++i) {
+                block.appendRow(spectra.rowSpan(i));
+                blockRows.appendRow();
+            }
+            batchBFCC.compute(block, blockRows);
+            for (size_t i = 0; i < blockRows.numRows(); ++i) {
+                batched.appendRow(blockRows.rowSpan(i));
+            }
+        }
+        const double batchMs = batchTimer.elapsedMs();
+
+        Real maxDifference {0.f};
+        for (size_t i = 0; i < numFrames; ++i) {
+            for (size_t c = 0; c < static_cast<size_t>(NumBFCC); ++c) {
+                maxDifference = std::max(maxDifference, std::abs(batched(i, c) - reference(i, c)));
+            }
+        }
+        const auto perFrame = [numFrames](const double ms) { return juce::String(1000.0 * ms / static_cast<double>(numFrames), 2) + " us/frame"; };
+        std::cout << "\tframe size " << frameSize << ", " << numFrames << " frames: Essentia BFCC " << perFrame(essentiaMs)
+                  << ", BatchBFCC " << perFrame(batchMs) << " (speedup " << juce::String(essentiaMs / std::max(batchMs, 1e-9), 2)
+                  << "x; tables " << juce::String(tablesMs, 1) << " ms, once per configuration per process)\n"
+                  << "\t\tmax |coefficient difference| " << juce::String(maxDifference, 6) << "\n";
+    }
+}
+
+// Essentia's Spectrum/PowerSpectrum frame by frame against SpectralFrontEnd on blocks of the same windowed frames, at a
+// few frame sizes (the last one not a power of two, so it takes the fallback): time per frame, and the largest
+// difference relative to each frame's strongest bin
+void benchmarkSpectralFrontEnd(Analyzer &analyzer, vecReal const &wave) {
+    constexpr size_t blockFrames {64};
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    std::cout << "spectralFrontEnd: " << wave.size() << " samples, blocks of " << blockFrames << " frames\n";
+    for (const int frameSize : {1024, 2048, 1500}) {
+        const auto windowing = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Windowing",
+            "normalized", false, "size", frameSize, "zeroPadding", frameSize,
+            "type", analyzer.getSettings().analysis.windowingType.toStdString(), "zeroPhase", false));
+        FeatureMatrix<Real> windowedFrames(static_cast<size_t>(frameSize) * 2);
+        vecReal frame, windowedFrame;
+        for (size_t start = 0; start + static_cast<size_t>(frameSize) <= wave.size(); start += static_cast<size_t>(frameSize / 2)) {
+            frame.assign(wave.begin() + static_cast<std::ptrdiff_t>(start),
+                         wave.begin() + static_cast<std::ptrdiff_t>(start) + frameSize);
+            windowing->input("frame").set(frame);
+            windowing->output("frame").set(windowedFrame);
+            windowing->compute();
+            windowedFrames.appendRow(windowedFrame);
+        }
+        const size_t numFrames = windowedFrames.numRows();
+        if (numFrames == 0) {
+            std::cout << "\tframe size " << frameSize << ": file too short\n";
+            continue;
+        }
+
+        struct Variant {
+            const char *name, *algorithm, *input, *output;
+            SpectralFrontEnd::Output frontEndOutput;
+        };
+        for (const Variant v : { Variant { "power", "PowerSpectrum", "signal", "powerSpectrum", SpectralFrontEnd::Output::Power },
+                                 Variant { "magnitude", "Spectrum", "frame", "spectrum", SpectralFrontEnd::Output::Magnitude } }) {
+            const auto spectrum = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create(v.algorithm,
+                "size", frameSize * 2));
+            FeatureMatrix<Real> reference(static_cast<size_t>(frameSize) + 1);
+            vecReal spectrumVec;
+            const Stopwatch essentiaTimer;
+            for (size_t i = 0; i < numFrames; ++i) {
+                const auto row = windowedFrames.rowSpan(i);
+                windowedFrame.assign(row.begin(), row.end());
+                spectrum->input(v.input).set(windowedFrame);
+                spectrum->output(v.output).set(spectrumVec);
+                spectrum->compute();
+                reference.appendRow(spectrumVec);
+            }
+            const double essentiaMs = essentiaTimer.elapsedMs();
+
+            SpectralFrontEnd frontEnd(frameSize * 2, v.frontEndOutput);
+            FeatureMatrix<Real> block(static_cast<size_t>(frameSize) * 2), blockSpectra, batched(frontEnd.getNumColumns());
+            const Stopwatch frontEndTimer;
+            for (size_t start = 0; start < numFrames; start += blockFrames) {
+                block.clearRows();
+                for (size_t i = start; i < std::min(start + blockFrames, numFrames); ++i) {
+                    block.appendRow(windowedFrames.rowSpan(i));
+                }
+                frontEnd.compute(block, blockSpectra);
+                for (size_t i = 0; i < blockSpectra.numRows(); ++i) {
+                    batched.appendRow(blockSpectra.rowSpan(i));
+                }
+            }
+            const double frontEndMs = frontEndTimer.elapsedMs();
+
+            Real maxRelative {0.f};
+            for (size_t i = 0; i < numFrames; ++i) {
+                const auto row = reference.rowSpan(i);
+                const Real strongest = std::max(*std::max_element(row.begin(), row.end()), 1e-12f);
+                for (size_t k = 0; k < row.size(); ++k) {
+                    maxRelative = std::max(maxRelative, std::abs(batched(i, k) - row[k]) / strongest);
+                }
+            }
+            const auto perFrame = [numFrames](const double ms) { return juce::String(1000.0 * ms / static_cast<double>(numFrames), 2) + " us/frame"; };
+            std::cout << "\tframe size " << frameSize << " (" << v.name << "), " << numFrames << " frames: Essentia "
+                      << perFrame(essentiaMs) << ", SpectralFrontEnd " << perFrame(frontEndMs)
+                      << " (speedup " << juce::String(essentiaMs / std::max(frontEndMs, 1e-9), 2) << "x)\n"
+                      << "\t\tmax difference relative to the strongest bin " << juce::String(maxRelative, 8) << "\n";
+        }
+    }
+}
+
+size_t getPeakResidentBytes() {
+#if JUCE_WINDOWS
+    return 0;   // not measured
+#else
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+   #if JUCE_MAC
+    return static_cast<size_t>(usage.ru_maxrss);          // bytes
+   #else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;   // kilobytes
+   #endif
+#endif
+}
+
+// peak RSS growth of the timbre stage relative to the audio size. event views run first, since peak RSS only ever
+// grows; the materialized events (as splitWaveIntoEvents + per-event copies did) run second for comparison.
+void benchmarkEventMemory(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto onsets = benchmarkOnsets(analyzer, wave, rls);
+    const auto audioBytes = static_cast<double>(wave.size() * sizeof(Real));
+    auto const toAudioMultiple = [audioBytes](const size_t before, const size_t after) {
+        return juce::String(static_cast<double>(after - before) / audioBytes, 2) + "x";
+    };
+
+    const size_t baseline = getPeakResidentBytes();
+    [[maybe_unused]] const auto viewResult = analyzer.calculateOnsetwiseTimbreSpace(wave, onsets, rls, neverExit);
+    const size_t afterViews = getPeakResidentBytes();
+
+    {
+        const vecVecReal events = splitWaveIntoEvents(wave, onsets, analyzer.ess_hold.factory, analyzer.getSettings(),
+                                                      rls, neverExit);
+        std::vector<FeatureContainer<Analyzer::EventwiseStats>> materialized(events.size());
+        for (size_t i = 0; i < events.size(); ++i) {
+            const vecReal eventCopy(events[i]);   // each eventwise function used to copy its event again
+            analyzer.calculateEventwiseTimbreDescription(eventCopy, materialized[i]);
+        }
+    }
+    const size_t afterMaterialized = getPeakResidentBytes();
+
+    std::cout << "eventMemory: audio " << juce::File::descriptionOfSizeInBytes(static_cast<juce::int64>(audioBytes))
+              << ", " << onsets.size() << " events\n"
+              << "\tpeak RSS growth, event views:        " << toAudioMultiple(baseline, afterViews) << " audio size\n"
+              << "\tpeak RSS growth, materialized events: " << toAudioMultiple(baseline, afterMaterialized)
+              << " audio size\n";
+}
+
+// the eventwise stage as it used to run: a juce::ThreadPool built per call, one job per event, sleep-polled.
+// eventMs[i] is set to the time event i's job took
+void describeEventsWithThreadPool(Analyzer &analyzer, vecReal const &wave, std::vector<EventView> const &events,
+                                  const int numThreads, std::span<double> eventMs) {
+    std::vector<FeatureContainer<Analyzer::EventwiseStats>> points(events.size());
+    juce::ThreadPool pool(juce::ThreadPoolOptions().withNumberOfThreads(numThreads).withThreadName("TimbreAnalysis"));
+    for (size_t i = 0; i < events.size(); ++i) {
+        pool.addJob([&, i] {
+            const Stopwatch eventTimer;
+            analyzer.calculateEventwiseDescription(events[i].of(wave), points[i]);
+            eventMs[i] = eventTimer.elapsedMs();
+        });
+    }
+    while (pool.getNumJobs() > 0) {
+        juce::Thread::sleep(10);
+    }
+}
+
+// the same, one task per event on the persistent scheduler
+void describeEventsWithScheduler(Analyzer &analyzer, vecReal const &wave, std::vector<EventView> const &events,
+                                 AnalysisScheduler &scheduler, std::span<double> eventMs) {
+    std::vector<FeatureContainer<Analyzer::EventwiseStats>> points(events.size());
+    scheduler.parallelFor(events.size(), [&](const size_t i, size_t) {
+        const Stopwatch eventTimer;
+        analyzer.calculateEventwiseDescription(events[i].of(wave), points[i]);
+        eventMs[i] = eventTimer.elapsedMs();
+    });
+}
+
+// per-call juce::ThreadPool vs. the persistent work-stealing AnalysisScheduler, across thread counts, one task per
+// event on both. each configuration runs several times: the median run gives throughput, and every event's time
+// inside its task, pooled over the runs, gives the latency percentiles.
+void benchmarkScheduler(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto onsets = benchmarkOnsets(analyzer, wave, rls);
+    const auto events = calculateEventViews(wave.size(), onsets, analyzer.getSettings());
+    if (events.empty()) {
+        std::cout << "scheduler: no events\n";
+        return;
+    }
+    constexpr size_t numRuns {5};
+
+    auto const summarize = [numEvents = static_cast<double>(events.size())](std::vector<double> runMs,
+                                                                             std::vector<double> eventMs) {
+        std::ranges::sort(runMs);
+        std::ranges::sort(eventMs);
+        const double medianMs = runMs[runMs.size() / 2];
+        auto const percentile = [&eventMs](const double p) {
+            const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(eventMs.size())));
+            return juce::String(eventMs[std::clamp<size_t>(rank, 1, eventMs.size()) - 1], 2);
+        };
+        return juce::String(1000.0 * numEvents / std::max(medianMs, 1e-9), 0) + " events/s (median run "
+             + juce::String(medianMs, 2) + " ms), per event p50/p95/p99/max " + percentile(0.5) + "/"
+             + percentile(0.95) + "/" + percentile(0.99) + "/" + juce::String(eventMs.back(), 2) + " ms";
+    };
+
+    std::cout << "scheduler: " << events.size() << " events, " << numRuns << " runs per configuration\n";
+    for (const int numThreads : {1, 2, 4, 8, 16, 32, 64}) {
+        std::vector<double> poolMs, schedulerMs;
+        std::vector<double> poolEventMs(events.size() * numRuns), schedulerEventMs(events.size() * numRuns);
+        auto const runSlice = [&events](std::vector<double> &eventMs, const size_t run) {
+            return std::span(eventMs).subspan(run * events.size(), events.size());
+        };
+        for (size_t run = 0; run < numRuns; ++run) {
+            const Stopwatch poolTimer;
+            describeEventsWithThreadPool(analyzer, wave, events, numThreads, runSlice(poolEventMs, run));
+            poolMs.push_back(poolTimer.elapsedMs());
+        }
+        // threads are started once, outside the timed runs, as the Analyzer-owned scheduler is
+        AnalysisScheduler scheduler(static_cast<size_t>(numThreads));
+        for (size_t run = 0; run < numRuns; ++run) {
+            const Stopwatch schedulerTimer;
+            describeEventsWithScheduler(analyzer, wave, events, scheduler, runSlice(schedulerEventMs, run));
+            schedulerMs.push_back(schedulerTimer.elapsedMs());
+        }
+        std::cout << "\t" << numThreads << " threads\n"
+                  << "\t\tjuce::ThreadPool:  " << summarize(std::move(poolMs), std::move(poolEventMs)) << "\n"
+                  << "\t\tAnalysisScheduler: " << summarize(std::move(schedulerMs), std::move(schedulerEventMs)) << "\n";
+    }
+}
+
+juce::String describeBatch(AnalysisScheduler::BatchStats const &stats) {
+    auto description = juce::String(stats.wallMs, 2) + " ms, core utilization " + juce::String(100.0 * stats.utilization(), 1) + "%";
+    if (stats.busyMs.empty()) {
+        return description + ", no workers";
+    }
+    const auto [minBusy, maxBusy] = std::ranges::minmax(stats.busyMs);
+    return description + ", busiest/idlest worker " + juce::String(maxBusy, 1) + "/" + juce::String(minBusy, 1) + " ms";
+}
+
+// the event stage with chunks submitted in onset order (as before) vs. longest-first
+void benchmarkLoadBalance(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto onsets = benchmarkOnsets(analyzer, wave, rls);
+    const auto events = calculateEventViews(wave.size(), onsets, analyzer.getSettings());
+    if (events.empty()) {
+        std::cout << "loadBalance: no events\n";
+        return;
+    }
+    const auto [shortest, longest] = std::ranges::minmax(events, {}, &EventView::length);
+    AnalysisScheduler scheduler(static_cast<size_t>(std::max(analyzer.getSettings().analysis.numThreads, 1)));
+
+    // same chunking as calculateEventwiseDescriptions, without the sort
+    size_t totalSamples {0};
+    for (auto const &e : events) {
+        totalSamples += e.length;
+    }
+    const auto chunks = chunkEventsBySampleCount(events, std::max<size_t>(totalSamples / (scheduler.getNumThreads() * 16), 1));
+    std::vector<FeatureContainer<Analyzer::EventwiseStats>> points(events.size());
+    const auto onsetOrder = scheduler.parallelFor(chunks.size(), [&](const size_t c, size_t) {
+        for (size_t i = chunks[c].begin; i < chunks[c].end; ++i) {
+            analyzer.calculateEventwiseDescription(events[i].of(wave), points[i]);
+        }
+    });
+
+    AnalysisScheduler::BatchStats longestFirst;
+    [[maybe_unused]] const auto sorted = analyzer.calculateEventwiseDescriptions(scheduler, wave, events, rls, neverExit,
+                                                                                 &longestFirst);
+
+    const auto sr = static_cast<double>(analyzer.getAnalyzedFileSampleRate());
+    std::cout << "loadBalance: " << events.size() << " events (" << juce::String(1000.0 * shortest.length / sr, 1)
+              << " to " << juce::String(1000.0 * longest.length / sr, 1) << " ms), " << scheduler.getNumThreads()
+              << " workers\n"
+              << "\tonset order:   " << describeBatch(onsetOrder) << "\n"
+              << "\tlongest first: " << describeBatch(longestFirst) << "\n";
+}
+
+// the detection matrix is computed once; onset tuning (alpha, silence threshold, weights) only re-picks from it
+void benchmarkOnsetRepick(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const Stopwatch matrixTimer;
+    const auto matrix = analyzer.calculateOnsetDetectionMatrix(wave, rls, neverExit);
+    const double matrixMs = matrixTimer.elapsedMs();
+    if (!matrix.has_value()) {
+        std::cerr << "onsetRepick: no detection matrix\n";
+        return;
+    }
+
+    const auto &factory = essentia::standard::AlgorithmFactory::instance();
+    AnalyzerSettings settings = analyzer.getSettings();
+    std::vector<double> repickMs;
+    size_t numOnsets {0};
+    for (const double alpha : {0.05, 0.1, 0.2, 0.4}) {
+        for (const double weight : {0.0, 0.5, 1.0}) {
+            settings.onset.alpha = alpha;
+            settings.onset.weight_hfc = weight;
+            settings.onset.weight_flux = 1.0 - weight;
+            const Stopwatch repickTimer;
+            numOnsets += calculateOnsetsInSeconds(matrix.value(), factory, settings).size();
+            repickMs.push_back(repickTimer.elapsedMs());
+        }
+    }
+    std::ranges::sort(repickMs);
+    std::cout << "onsetRepick: " << matrix->dim2() << " detection frames\n"
+              << "\tdetection matrix (all 5 functions): " << juce::String(matrixMs, 2) << " ms\n"
+              << "\tre-pick from matrix: median " << juce::String(repickMs[repickMs.size() / 2], 3) << " ms, worst "
+              << juce::String(repickMs.back(), 3) << " ms (" << repickMs.size() << " settings, "
+              << numOnsets / repickMs.size() << " onsets on average)\n";
+}
+
+// prints how far each detection function of b is from a's, relative to its peak, and whether both pick the same onsets.
+// returns whether they agree within tolerance
+bool compareOnsetMatrices(array2dReal const &a, array2dReal const &b, AnalyzerSettings const &settings, const Real tolerance) {
+    if (a.dim1() != b.dim1() || a.dim2() != b.dim2()) {
+        std::cout << "\tmatrix sizes differ: " << a.dim1() << "x" << a.dim2() << " vs. " << b.dim1() << "x" << b.dim2() << "\n";
+        return false;
+    }
+    bool withinTolerance {true};
+    constexpr std::array names {"hfc", "complex", "complex_phase", "flux", "rms"};
+    for (int i = 0; i < a.dim1(); ++i) {
+        Real peak {0.f}, maxDiff {0.f};
+        for (int j = 0; j < a.dim2(); ++j) {
+            peak = std::max(peak, std::abs(a[i][j]));
+            maxDiff = std::max(maxDiff, std::abs(a[i][j] - b[i][j]));
+        }
+        const Real relativeDiff = peak > 0.f ? maxDiff / peak : maxDiff;
+        withinTolerance = withinTolerance && relativeDiff <= tolerance;
+        std::cout << "\t" << names[static_cast<size_t>(i)] << ": max |difference| " << maxDiff
+                  << " (" << relativeDiff << " of peak)\n";
+    }
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    const auto onsetsA = calculateOnsetsInSeconds(a, standardFac, settings);
+    const auto onsetsB = calculateOnsetsInSeconds(b, standardFac, settings);
+    const bool sameOnsets = onsetsA.size() == onsetsB.size()
+        && std::ranges::equal(onsetsA, onsetsB, [](Real x, Real y) { return std::abs(x - y) < 1e-6f; });
+    std::cout << "\tonsets: " << onsetsA.size() << " vs. " << onsetsB.size() << (sameOnsets ? ", identical" : ", DIFFERENT") << "\n";
+    return withinTolerance && sameOnsets;
+}
+
+// serial onset detection network vs. the same network run in overlapping chunks. checks that the detection matrix
+// (and the onsets picked from it) agree, e.g. on audio/noise_bursts.wav and audio/sweep.wav.
+// FrameCutter adds low-level random noise to silent frames, so the two can differ slightly there.
+void benchmarkOnsetChunks(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto &settings = analyzer.getSettings();
+
+    const Stopwatch serialTimer;
+    const auto serial = calculateOnsetsMatrix(wave, analyzer.ess_hold.factory, settings, rls, neverExit);
+    const double serialMs = serialTimer.elapsedMs();
+
+    AnalysisScheduler scheduler(static_cast<size_t>(std::max(settings.analysis.numThreads, 1)));
+    const Stopwatch chunkedTimer;
+    const auto chunked = calculateOnsetsMatrixInChunks(wave, analyzer.ess_hold.factory, settings, scheduler, rls, neverExit);
+    const double chunkedMs = chunkedTimer.elapsedMs();
+
+    constexpr Real tolerance {1e-4f};   // relative to each detection function's peak
+    std::cout << "onsetChunks: " << serial.dim2() << " serial frames, " << chunked.dim2() << " chunked frames, "
+              << scheduler.getNumThreads() << " workers\n";
+    const bool withinTolerance = compareOnsetMatrices(serial, chunked, settings, tolerance);
+    std::cout << "\tserial: " << juce::String(serialMs, 2) << " ms, chunked: " << juce::String(chunkedMs, 2)
+              << " ms (speedup " << juce::String(serialMs / std::max(chunkedMs, 1e-9), 2) << "x)\n"
+              << "\t" << (withinTolerance ? "PASS" : "FAIL") << ": chunked matrix within " << tolerance
+              << " of serial\n";
+}
+
+// the onset stage with five OnsetDetection algorithms vs. the fused OnsetDetectionKernel, both serial.
+// the kernel takes phase differences as phasor products rather than wrapped angle differences, so the two agree to
+// float rounding (plus FrameCutter's noise in silent frames), not bit for bit.
+void benchmarkOnsetFused(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    AnalyzerSettings settings = analyzer.getSettings();
+
+    settings.onset.fusedDetection = false;
+    const Stopwatch separateTimer;
+    const auto separate = calculateOnsetsMatrix(wave, analyzer.ess_hold.factory, settings, rls, neverExit);
+    const double separateMs = separateTimer.elapsedMs();
+
+    settings.onset.fusedDetection = true;
+    const Stopwatch fusedTimer;
+    const auto fused = calculateOnsetsMatrix(wave, analyzer.ess_hold.factory, settings, rls, neverExit);
+    const double fusedMs = fusedTimer.elapsedMs();
+
+    constexpr Real tolerance {1e-3f};
+    std::cout << "onsetFused: " << separate.dim2() << " frames\n";
+    const bool withinTolerance = compareOnsetMatrices(separate, fused, settings, tolerance);
+    std::cout << "\tOnsetDetection x5: " << juce::String(separateMs, 2) << " ms, fused kernel: "
+              << juce::String(fusedMs, 2) << " ms (speedup " << juce::String(separateMs / std::max(fusedMs, 1e-9), 2)
+              << "x, including resampling)\n"
+              << "\t" << (withinTolerance ? "PASS" : "FAIL") << ": fused matrix within " << tolerance
+              << " of OnsetDetection's\n";
+}
+
+// onset detection at 44.1/48/96/192 kHz (the file resampled to each), with each RateConversion: time spent, and how far
+// the onsets move from the ones found by resampling to 44.1 kHz
+void benchmarkOnsetRates(Analyzer &analyzer, vecReal const &wave) {
+    using RateConversion = AnalyzerSettings::Onset::RateConversion;
+    RunLoopStatus rls;
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    const auto fileSampleRate = analyzer.getSettings().analysis.sampleRate;
+
+    constexpr std::array<std::pair<RateConversion, const char *>, 3> conversions {{
+        { RateConversion::Resample, "resample" }, { RateConversion::Native, "native" }, { RateConversion::Decimate, "decimate" }
+    }};
+    std::cout << "onsetRates: " << wave.size() << " samples at " << fileSampleRate << " Hz\n";
+    for (const double sampleRate : {44100.0, 48000.0, 96000.0, 192000.0}) {
+        vecReal atRate;
+        if (sampleRate == fileSampleRate) {
+            atRate = wave;
+        } else {
+            const auto resampler = std::unique_ptr<essentia::standard::Algorithm>(standardFac.create("Resample",
+                "inputSampleRate", static_cast<Real>(fileSampleRate),
+                "outputSampleRate", static_cast<Real>(sampleRate),
+                "quality", 1));
+            resampler->input("signal").set(wave);
+            resampler->output("signal").set(atRate);
+            resampler->compute();
+        }
+
+        AnalyzerSettings settings = analyzer.getSettings();
+        settings.analysis.sampleRate = sampleRate;
+        std::cout << "\t" << juce::String(sampleRate / 1000.0, 1) << " kHz:\n";
+
+        vecReal referenceOnsets;
+        for (auto const &[conversion, name] : conversions) {
+            settings.onset.rateConversion = conversion;
+            const auto geometry = getOnsetFrameGeometry(settings);
+            const Stopwatch timer;
+            const auto matrix = calculateOnsetsMatrix(atRate, analyzer.ess_hold.factory, settings, rls, neverExit);
+            const double ms = timer.elapsedMs();
+            const auto onsets = calculateOnsetsInSeconds(matrix, standardFac, settings);
+            if (conversion == RateConversion::Resample) {
+                referenceOnsets = onsets;
+            }
+            // distance from each onset to the nearest reference onset
+            Real maxShift {0.f};
+            for (const auto t : onsets) {
+                Real nearest {std::numeric_limits<Real>::max()};
+                for (const auto r : referenceOnsets) {
+                    nearest = std::min(nearest, std::abs(t - r));
+                }
+                maxShift = std::max(maxShift, nearest);
+            }
+            std::cout << "\t\t" << name << " (" << juce::String(geometry.sampleRate / 1000.f, 1) << " kHz, hop "
+                      << geometry.hopSize << ", frame " << geometry.frameSize << "): " << juce::String(ms, 2) << " ms, "
+                      << matrix.dim2() << " frames, " << onsets.size() << " onsets (" << referenceOnsets.size()
+                      << " resampled), max shift " << juce::String(1000.f * maxShift, 1) << " ms\n";
+        }
+    }
+}
+
+// feeds the file through LiveAnalyzer in audio-callback sized blocks, as a live input would arrive: how much faster
+// than real time it runs, how long after an event's end it is emitted, and whether memory stays flat
+void benchmarkLiveStream(Analyzer &analyzer, vecReal const &wave) {
+    RunLoopStatus rls;
+    const auto &settings = analyzer.getSettings();
+    const auto offlineOnsets = benchmarkOnsets(analyzer, wave, rls);
+
+    size_t numEvents {0};
+    juce::int64 maxDelay {0}, totalDelay {0};
+    LiveAnalyzer *live {nullptr};
+    LiveAnalyzer liveAnalyzer(settings, [&](LiveAnalyzer::Event const &event) {
+        // samples analyzed beyond the event's end by the time it is emitted
+        const auto delay = live->getNumSamplesAnalyzed() - (event.startSample + event.lengthInSamples);
+        maxDelay = std::max(maxDelay, delay);
+        totalDelay += delay;
+        ++numEvents;
+    });
+    live = &liveAnalyzer;
+
+    constexpr int blockSize {256};
+    const size_t peakBytesBefore = getPeakResidentBytes();
+    const Stopwatch timer;
+    for (size_t i = 0; i < wave.size(); i += blockSize) {
+        const auto n = static_cast<int>(std::min<size_t>(blockSize, wave.size() - i));
+        liveAnalyzer.pushAudio(wave.data() + i, n);
+        liveAnalyzer.process();
+    }
+    liveAnalyzer.flush();
+    const double ms = timer.elapsedMs();
+    const size_t peakBytesAfter = getPeakResidentBytes();
+
+    const double audioMs = 1000.0 * static_cast<double>(wave.size()) / settings.analysis.sampleRate;
+    const auto toMs = [&](const double samples) { return juce::String(1000.0 * samples / settings.analysis.sampleRate, 1); };
+    std::cout << "liveStream: " << numEvents << " events (" << offlineOnsets.size() << " offline onsets), blocks of "
+              << blockSize << " samples\n"
+              << "\t" << juce::String(ms, 2) << " ms for " << juce::String(audioMs, 2) << " ms of audio ("
+              << juce::String(audioMs / std::max(ms, 1e-9), 1) << "x real time)\n"
+              << "\temitted after the event's end: mean "
+              << toMs(numEvents > 0 ? static_cast<double>(totalDelay) / static_cast<double>(numEvents) : 0.0)
+              << " ms, max " << toMs(static_cast<double>(maxDelay)) << " ms (bound " << toMs(static_cast<double>(liveAnalyzer.getLatencyInSamples()))
+              << " ms)\n"
+              << "\tpeak resident growth while streaming: " << (peakBytesAfter - peakBytesBefore) / 1024 << " KiB, "
+              << liveAnalyzer.getNumDroppedSamples() << " samples dropped\n";
+}
+
+// opening and reading the benchmarked file through AudioFormatReader::read against a memory mapping: how long until
+// the first samples are available, and until all of them have been read
+void benchmarkMappedInput(Analyzer &analyzer, vecReal const &wave) {
+    const juce::File file(analyzer.getSettings().info.sampleFilePath);
+    constexpr int chunkSize {1 << 16};
+    const auto readAll = [&](juce::AudioFormatReader &reader, vecReal &dest) {
+        dest.resize(static_cast<size_t>(reader.lengthInSamples));
+        for (juce::int64 position = 0; position < reader.lengthInSamples; position += chunkSize) {
+            float *d = dest.data() + position;
+            reader.read(&d, 1, position, static_cast<int>(std::min<juce::int64>(chunkSize, reader.lengthInSamples - position)));
+        }
+    };
+
+    vecReal decoded;
+    const Stopwatch decodeTimer;
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    const auto reader = std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file));
+    if (reader == nullptr) {
+        std::cerr << "mappedInput: could not open " << file.getFullPathName() << "\n";
+        return;
+    }
+    const double decodeOpenMs = decodeTimer.elapsedMs();
+    readAll(*reader, decoded);
+    const double decodeMs = decodeTimer.elapsedMs();
+
+    const Stopwatch mapTimer;
+    const auto mapped = MappedAudioFile::open(file);
+    if (mapped == nullptr) {
+        std::cout << "mappedInput: " << file.getFileName() << " is not uncompressed WAV/AIFF\n";
+        return;
+    }
+    const double mapOpenMs = mapTimer.elapsedMs();
+    vecReal fromMapping;
+    const bool inPlace = !mapped->getFloatSamples().empty();
+    if (inPlace) {
+        // a straight copy out of the page cache, as readIntoWave does
+        fromMapping.assign(mapped->getFloatSamples().begin(), mapped->getFloatSamples().end());
+    } else {
+        readAll(mapped->getReader(), fromMapping);
+    }
+    const double mapMs = mapTimer.elapsedMs();
+
+    const bool same = fromMapping.size() == decoded.size() && std::ranges::equal(fromMapping, decoded);
+    std::cout << "mappedInput: " << decoded.size() << " samples (" << wave.size() << " analyzed), "
+              << (inPlace ? "mono float, in place" : "converted per chunk") << (same ? "" : ", MISMATCH") << "\n"
+              << "\tAudioFormatReader: open " << juce::String(decodeOpenMs, 3) << " ms, all samples "
+              << juce::String(decodeMs, 2) << " ms\n"
+              << "\tmemory mapped:     open " << juce::String(mapOpenMs, 3) << " ms, all samples "
+              << juce::String(mapMs, 2) << " ms\n";
+}
+
+// the cost of creating analyzers now that Essentia is initialized once per process and workers start on first use:
+// 1000 created and destroyed in turn, then 1000 alive at once, created from several threads. two of those then detect
+// onsets concurrently, which must agree with each other.
+void benchmarkAnalyzerStartup(Analyzer &analyzer, vecReal const &wave) {
+    constexpr size_t numAnalyzers {1000};
+    constexpr size_t numCreatingThreads {8};
+
+    const Stopwatch sequentialTimer;
+    for (size_t i = 0; i < numAnalyzers; ++i) {
+        const Analyzer a;
+    }
+    const double sequentialMs = sequentialTimer.elapsedMs();
+
+    std::vector<std::unique_ptr<Analyzer>> analyzers(numAnalyzers);
+    const Stopwatch concurrentTimer;
+    {
+        std::vector<std::thread> creators;
+        for (size_t t = 0; t < numCreatingThreads; ++t) {
+            creators.emplace_back([&analyzers, t] {
+                for (size_t i = t; i < numAnalyzers; i += numCreatingThreads) {
+                    analyzers[i] = std::make_unique<Analyzer>();
+                }
+            });
+        }
+        for (auto &c : creators) {
+            c.join();
+        }
+    }
+    const double concurrentMs = concurrentTimer.elapsedMs();
+
+    // a few seconds is enough to show they work side by side
+    const auto numSamples = std::min(wave.size(), static_cast<size_t>(10.0 * analyzer.getSettings().analysis.sampleRate));
+    const vecReal excerpt(wave.begin(), wave.begin() + static_cast<std::ptrdiff_t>(numSamples));
+    auto settingsParentTree = createParentTreeFromSettings(analyzer.getSettings());
+    auto settingsTree = settingsParentTree.getChildWithName(axiom::tsn::Settings);
+    std::array<std::optional<array2dReal>, 2> matrices;
+    {
+        std::vector<std::thread> detectors;
+        for (size_t i = 0; i < matrices.size(); ++i) {
+            analyzers[i]->updateSettings(settingsTree, true);
+            detectors.emplace_back([&, i] {
+                RunLoopStatus rls;
+                matrices[i] = analyzers[i]->calculateOnsetDetectionMatrix(excerpt, rls, neverExit);
+            });
+        }
+        for (auto &d : detectors) {
+            d.join();
+        }
+    }
+    const bool agree = matrices[0].has_value() && matrices[1].has_value()
+        && compareOnsetMatrices(*matrices[0], *matrices[1], analyzer.getSettings(), 0.f);
+
+    const Stopwatch destroyTimer;
+    analyzers.clear();
+    const double destroyMs = destroyTimer.elapsedMs();
+
+    std::cout << "analyzerStartup: " << numAnalyzers << " analyzers\n"
+              << "\tcreated and destroyed in turn: " << juce::String(sequentialMs, 2) << " ms ("
+              << juce::String(1000.0 * sequentialMs / numAnalyzers, 2) << " us each)\n"
+              << "\tall alive, created on " << numCreatingThreads << " threads: " << juce::String(concurrentMs, 2)
+              << " ms, destroyed in " << juce::String(destroyMs, 2) << " ms\n"
+              << "\ttwo detecting onsets concurrently: " << (agree ? "identical" : "MISMATCH") << "\n";
+}
+
+// writing and loading the results of a large corpus file as XML (a child per event, a property per feature and
+// statistic, as a host app's ValueTree would hold them) against the binary result file
+void benchmarkResultFormat(Analyzer &analyzer, vecReal const &) {
+    constexpr size_t numEvents {20000};
+    constexpr auto numFeatures = static_cast<size_t>(Feature_e::NumFeatures);
+    constexpr auto numStatistics = static_cast<size_t>(Statistic::NumStatistics);
+    std::vector<FeatureContainer<EventwiseStatistics<Real>>> measurements(numEvents);
+    vecReal onsets(numEvents);
+    juce::Random random(1);
+    for (size_t e = 0; e < numEvents; ++e) {
+        onsets[e] = static_cast<Real>(e) / static_cast<Real>(numEvents);
+        for (auto &f : measurements[e].features) {
+            f = { random.nextFloat(), random.nextFloat(), random.nextFloat(), random.nextFloat(), random.nextFloat() };
+        }
+    }
+    const juce::TemporaryFile xmlFile(".xml"), binaryFile(AnalysisResultFile::fileExtension);
+
+    std::vector<juce::Identifier> ids;
+    for (size_t i = 0; i < numFeatures * numStatistics; ++i) {
+        ids.emplace_back("f" + juce::String(i / numStatistics) + "s" + juce::String(i % numStatistics));
+    }
+    const Stopwatch xmlWriteTimer;
+    {
+        juce::ValueTree tree(axiom::tsn::TimbreMeasurements);
+        for (auto const &m : measurements) {
+            juce::ValueTree event("Event");
+            for (size_t i = 0; i < ids.size(); ++i) {
+                auto const &f = m.features[i / numStatistics];
+                const std::array values {f.mean, f.median, f.variance, f.skewness, f.kurtosis};
+                event.setProperty(ids[i], values[i % numStatistics], nullptr);
+            }
+            tree.appendChild(event, nullptr);
+        }
+        xmlFile.getFile().replaceWithText(tree.toXmlString());
+    }
+    const double xmlWriteMs = xmlWriteTimer.elapsedMs();
+    const Stopwatch xmlLoadTimer;
+    const auto loadedTree = juce::ValueTree::fromXml(xmlFile.getFile().loadFileAsString());
+    double xmlSum {0.0};
+    for (const auto &event : loadedTree) {
+        xmlSum += static_cast<double>(event[ids[static_cast<size_t>(Feature_e::Loudness) * numStatistics]]);
+    }
+    const double xmlLoadMs = xmlLoadTimer.elapsedMs();
+
+    const Stopwatch binaryWriteTimer;
+    // a second per event, as far as the stored length is concerned
+    const double sampleRate = analyzer.getSettings().analysis.sampleRate;
+    const AnalysisResultFile::Info info { "benchmark", analyzer.getSettingsHash(), sampleRate,
+                                          static_cast<juce::int64>(sampleRate) * static_cast<juce::int64>(numEvents) };
+    const bool written = AnalysisResultFile::write(binaryFile.getFile(), info, onsets, measurements);
+    const double binaryWriteMs = binaryWriteTimer.elapsedMs();
+    const Stopwatch binaryLoadTimer;
+    const auto mapped = MappedAnalysisResultFile::open(binaryFile.getFile());
+    double binarySum {0.0};
+    if (mapped != nullptr) {
+        for (const auto x : mapped->getColumn(Feature_e::Loudness, Statistic::Mean)) {
+            binarySum += static_cast<double>(x);
+        }
+    }
+    const double binaryLoadMs = binaryLoadTimer.elapsedMs();
+
+    const bool roundTrips = written && mapped != nullptr
+        && std::ranges::equal(mapped->getOnsets(), onsets)
+        && mapped->getInfo().numSamples == info.numSamples
+        && std::memcmp(mapped->getTimbreMeasurements().data(), measurements.data(),
+                       numEvents * sizeof(measurements.front())) == 0;
+    std::cout << "resultFormat: " << numEvents << " events x " << numFeatures << " features x " << numStatistics
+              << " statistics, one column summed on load" << (roundTrips ? "" : ", binary round trip FAILED") << "\n"
+              << "\tXML:    " << juce::File::descriptionOfSizeInBytes(xmlFile.getFile().getSize()) << ", write "
+              << juce::String(xmlWriteMs, 2) << " ms, load " << juce::String(xmlLoadMs, 2) << " ms (sum " << xmlSum << ")\n"
+              << "\tbinary: " << juce::File::descriptionOfSizeInBytes(binaryFile.getFile().getSize()) << ", write "
+              << juce::String(binaryWriteMs, 2) << " ms, load " << juce::String(binaryLoadMs, 3) << " ms (sum "
+              << binarySum << ")\n";
+}
+
+}   // anonymous namespace
+
+const std::map<juce::String, BenchmarkFn> &getBenchmarks() {
+    static const std::map<juce::String, BenchmarkFn> benchmarks {
+        { "eventFraming", benchmarkEventFraming },
+        { "algorithmCache", benchmarkAlgorithmCache },
+        { "featureSubset", benchmarkFeatureSubset },
+        { "fastYin", benchmarkFastYin },
+        { "pitchBackends", benchmarkPitchBackends },
+        { "spectralDescriptors", benchmarkSpectralDescriptors },
+        { "batchBFCC", benchmarkBatchBFCC },
+        { "spectralFrontEnd", benchmarkSpectralFrontEnd },
+        { "eventMemory", benchmarkEventMemory },
+        { "scheduler", benchmarkScheduler },
+        { "loadBalance", benchmarkLoadBalance },
+        { "onsetRepick", benchmarkOnsetRepick },
+        { "onsetChunks", benchmarkOnsetChunks },
+        { "onsetRates", benchmarkOnsetRates },
+        { "onsetFused", benchmarkOnsetFused },
+        { "liveStream", benchmarkLiveStream },
+        { "mappedInput", benchmarkMappedInput },
+        { "analyzerStartup", benchmarkAnalyzerStartup },
+        { "resultFormat", benchmarkResultFormat }
+    };
+    return benchmarks;
+}
+
+bool runBenchmarks(const juce::String &name, Analyzer &analyzer, vecReal const &wave) {
+    const auto &benchmarks = getBenchmarks();
+    if (name.isEmpty()) {
+        for (auto const &[benchmarkName, fn] : benchmarks) {
+            std::cout << "running " << benchmarkName << "...\n";
+            fn(analyzer, wave);
+        }
+        return true;
+    }
+    const auto it = benchmarks.find(name);
+    if (it == benchmarks.end()) {
+        return false;
+    }
+    it->second(analyzer, wave);
+    return true;
+}
+
+} // namespace nvs::analysis::benchmark
@@ -0,0 +1,18 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include "Analyzer.h"
+
+namespace nvs::analysis::benchmark {
+
+// each benchmark prints its own report to stdout
+using BenchmarkFn = std::function<void(Analyzer &analyzer, vecReal const &wave)>;
+
+const std::map<juce::String, BenchmarkFn> &getBenchmarks();
+
+// runs the named benchmark, or all of them if name is empty. returns false if no benchmark has that name.
+bool runBenchmarks(const juce::String &name, Analyzer &analyzer, vecReal const &wave);
+
+} // namespace nvs::analysis::benchmark
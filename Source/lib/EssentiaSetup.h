@@ -14,13 +14,22 @@
 namespace nvs {
 namespace ess {
 
+// Essentia's algorithm registry is process-wide, so it is initialized once, by whichever initializer is constructed
+// first, and shut down at exit rather than when any one owner goes away while others may still be using it.
+// constructing further initializers (and so further Analyzers) costs only a check of the static below.
 struct EssentiaInitializer {
 	EssentiaInitializer(){
-		essentia::init();
-	}
-	~EssentiaInitializer(){
-		essentia::shutdown();
+		static const Runtime runtime;
 	}
+private:
+	struct Runtime {
+		Runtime(){
+			essentia::init();
+		}
+		~Runtime(){
+			essentia::shutdown();
+		}
+	};
 };
 
 // instantiates Essentia
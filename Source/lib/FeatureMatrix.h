@@ -0,0 +1,161 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <span>
+#include <vector>
+
+namespace nvs::analysis {
+
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+    T *allocate(const size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+    void deallocate(T *p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+};
+
+// non-owning view of every stride-th element, e.g. one feature across all frames of a row-major matrix
+template <typename T>
+class StridedView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *;
+        using reference = T &;
+
+        Iterator() = default;
+        Iterator(T *p, const std::ptrdiff_t stride) : _p(p), _stride(stride) {}
+
+        reference operator*() const { return *_p; }
+        reference operator[](const difference_type n) const { return _p[n * _stride]; }
+        Iterator &operator++() { _p += _stride; return *this; }
+        Iterator operator++(int) { auto tmp = *this; ++*this; return tmp; }
+        Iterator &operator--() { _p -= _stride; return *this; }
+        Iterator operator--(int) { auto tmp = *this; --*this; return tmp; }
+        Iterator &operator+=(const difference_type n) { _p += n * _stride; return *this; }
+        Iterator &operator-=(const difference_type n) { _p -= n * _stride; return *this; }
+        friend Iterator operator+(Iterator it, const difference_type n) { return it += n; }
+        friend Iterator operator+(const difference_type n, Iterator it) { return it += n; }
+        friend Iterator operator-(Iterator it, const difference_type n) { return it -= n; }
+        friend difference_type operator-(const Iterator &a, const Iterator &b) { return (a._p - b._p) / a._stride; }
+        friend bool operator==(const Iterator &a, const Iterator &b) { return a._p == b._p; }
+        friend auto operator<=>(const Iterator &a, const Iterator &b) { return a._p <=> b._p; }
+    private:
+        T *_p {nullptr};
+        std::ptrdiff_t _stride {1};
+    };
+
+    StridedView(T *data, const size_t size, const size_t stride) : _data(data), _size(size), _stride(stride) {}
+
+    T &operator[](const size_t i) const { return _data[i * _stride]; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    size_t stride() const { return _stride; }
+
+    Iterator begin() const { return {_data, static_cast<std::ptrdiff_t>(_stride)}; }
+    Iterator end() const { return begin() + static_cast<std::ptrdiff_t>(_size); }
+
+private:
+    T *_data;
+    size_t _size, _stride;
+};
+
+enum class MatrixLayout {
+    RowMajor,       // each frame (row) is contiguous; appending frames is cheap
+    ColumnMajor     // each feature (column) is contiguous
+};
+
+/**
+ * Contiguous, 64-byte aligned frames x features matrix, replacing one std::vector per feature (or per frame).
+ * Rows are frames (or events), columns are features. Both rows and columns are available as strided views, so
+ * framewise and featurewise access need no transpose and no per-row allocation.
+ */
+template <typename T, MatrixLayout Layout = MatrixLayout::RowMajor>
+class FeatureMatrix {
+public:
+    FeatureMatrix() = default;
+    explicit FeatureMatrix(const size_t numColumns, const size_t numRows = 0)
+    :   _numRows(numRows), _numColumns(numColumns), _data(numRows * numColumns, T{}) {}
+
+    size_t numRows() const { return _numRows; }
+    size_t numColumns() const { return _numColumns; }
+    bool empty() const { return _numRows == 0; }
+
+    T *data() { return _data.data(); }
+    const T *data() const { return _data.data(); }
+
+    T &operator()(const size_t r, const size_t c) { return _data[index(r, c)]; }
+    const T &operator()(const size_t r, const size_t c) const { return _data[index(r, c)]; }
+
+    StridedView<T> row(const size_t r) {
+        return {_data.data() + index(r, 0), _numColumns, columnStride()};
+    }
+    StridedView<const T> row(const size_t r) const {
+        return {_data.data() + index(r, 0), _numColumns, columnStride()};
+    }
+    StridedView<T> column(const size_t c) {
+        return {_data.data() + index(0, c), _numRows, rowStride()};
+    }
+    StridedView<const T> column(const size_t c) const {
+        return {_data.data() + index(0, c), _numRows, rowStride()};
+    }
+
+    // removes every row, keeping the memory for the next ones
+    void clearRows() {
+        _data.clear();
+        _numRows = 0;
+    }
+    void reserveRows(const size_t numRows) requires (Layout == MatrixLayout::RowMajor) {
+        _data.reserve(numRows * _numColumns);
+    }
+    // appends a zeroed row and returns it, to be filled in place
+    std::span<T> appendRow() requires (Layout == MatrixLayout::RowMajor) {
+        _data.resize(_data.size() + _numColumns, T{});
+        ++_numRows;
+        return {_data.data() + index(_numRows - 1, 0), _numColumns};
+    }
+    void appendRow(std::span<const T> values) requires (Layout == MatrixLayout::RowMajor) {
+        assert (values.size() == _numColumns);
+        _data.insert(_data.end(), values.begin(), values.end());
+        ++_numRows;
+    }
+    // contiguous row, only in row-major layout
+    std::span<const T> rowSpan(const size_t r) const requires (Layout == MatrixLayout::RowMajor) {
+        return {_data.data() + index(r, 0), _numColumns};
+    }
+    // contiguous column, only in column-major layout
+    std::span<const T> columnSpan(const size_t c) const requires (Layout == MatrixLayout::ColumnMajor) {
+        return {_data.data() + index(0, c), _numRows};
+    }
+
+private:
+    size_t _numRows {0}, _numColumns {0};
+    std::vector<T, AlignedAllocator<T>> _data;
+
+    size_t rowStride() const { return Layout == MatrixLayout::RowMajor ? _numColumns : 1; }
+    size_t columnStride() const { return Layout == MatrixLayout::RowMajor ? 1 : _numRows; }
+    size_t index(const size_t r, const size_t c) const { return r * rowStride() + c * columnStride(); }
+};
+
+} // namespace nvs::analysis
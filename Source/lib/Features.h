@@ -11,6 +11,10 @@
 #pragma once
 #include <span>
 #include <set>
+#include <array>
+#include <algorithm>
+
+#include "FeatureMatrix.h"
 
 namespace nvs::analysis {
 
@@ -43,8 +47,8 @@ enum class Feature_e {
 	NumFeatures
 };
 static constexpr int NumBFCC = 13;
-static constexpr auto NumTimbralFeatures = static_cast<int>(Feature_e::StrongPeak);
-static_assert(NumTimbralFeatures == 18);
+static constexpr auto NumTimbralFeatures = static_cast<int>(Feature_e::Periodicity);
+static_assert(NumTimbralFeatures == 19);
 
 const std::set bfccSet {
 	Feature_e::bfcc0,
@@ -79,11 +83,13 @@ struct FeatureContainer {
     std::span<T> bfccs() { return {features.data(), NumBFCC}; }
     std::span<const T> bfccs() const { return {features.data(), NumBFCC}; }
 };
-inline void pushBFCCFrame(FeatureContainer<std::vector<float>>& container, std::span<const float> bfccFrame) {
+// appends a frame (row) holding the BFCCs in its first NumBFCC columns, and returns it so the remaining features can be filled in place
+inline std::span<float> pushBFCCFrame(FeatureMatrix<float>& frames, std::span<const float> bfccFrame) {
     assert(bfccFrame.size() == NumBFCC);
-    for (size_t i = 0; i < NumBFCC; ++i) {
-        container[static_cast<Feature_e>(i)].push_back(bfccFrame[i]);
-    }
+    assert(NumBFCC <= frames.numColumns());
+    const auto row = frames.appendRow();
+    std::copy_n(bfccFrame.begin(), NumBFCC, row.begin());
+    return row;
 }
 
 }	// namespace nvs::analysis
@@ -0,0 +1,256 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "LiveAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace nvs::analysis {
+
+namespace {
+
+constexpr int readBlockSize {512};
+constexpr double runningMaxHalfLifeSeconds {10.0};
+constexpr double minimumOnsetDeltaSeconds {0.02};  // as filterOnsets
+
+OnsetFrameGeometry getLiveOnsetGeometry(AnalyzerSettings settings) {
+    settings.onset.rateConversion = AnalyzerSettings::Onset::RateConversion::Native;
+    return getOnsetFrameGeometry(settings);
+}
+
+juce::int64 getOnsetLookahead(AnalyzerSettings const &settings) {
+    return std::max(1, settings.onset.numFrames_shortOnsetFilter);
+}
+
+juce::int64 getHalfFrame(OnsetFrameGeometry const &geometry) {
+    return (geometry.frameSize + 1) / 2;   // the first onset frame is centered on the first sample
+}
+
+// enough history for the oldest sample any pending frame can still need: the onset detection latency, plus an event
+// frame that waits for it, plus the read block that arrives before anything is consumed
+size_t getHistoryCapacity(AnalyzerSettings const &settings, OnsetFrameGeometry const &geometry) {
+    const juce::int64 onsetLatency = getOnsetLookahead(settings) * geometry.hopSize
+        + geometry.frameSize - getHalfFrame(geometry) + geometry.hopSize;
+    const juce::int64 eventFrameSpan = settings.analysis.frameSize + settings.analysis.hopSize + settings.split.fadeOutSamps;
+    return static_cast<size_t>(2 * (onsetLatency + geometry.frameSize + eventFrameSpan + readBlockSize));
+}
+
+}   // anonymous namespace
+
+void LiveAnalyzer::SampleHistory::append(const std::span<const Real> samples) {
+    const auto capacity = static_cast<juce::int64>(_buffer.size());
+    for (const auto x : samples) {
+        _buffer[static_cast<size_t>(_end % capacity)] = x;
+        ++_end;
+    }
+}
+
+void LiveAnalyzer::SampleHistory::copy(const juce::int64 start, const size_t n, Real *dest) const {
+    const auto capacity = static_cast<juce::int64>(_buffer.size());
+    for (size_t i = 0; i < n; ++i) {
+        const auto idx = start + static_cast<juce::int64>(i);
+        jassert (idx < _end && idx >= _end - capacity);   // not yet pushed, or already overwritten
+        dest[i] = idx < 0 ? 0.f : _buffer[static_cast<size_t>(idx % capacity)];
+    }
+}
+
+LiveAnalyzer::LiveAnalyzer(AnalyzerSettings const &settings, EventCallback onEvent, const int fifoSizeInSamples)
+:   _settings(settings)
+,   _onEvent(std::move(onEvent))
+,   _fifo(fifoSizeInSamples)
+,   _fifoBuffer(static_cast<size_t>(fifoSizeInSamples))
+,   _onsetGeometry(getLiveOnsetGeometry(settings))
+,   _onsetKernel(_onsetGeometry)
+,   _pipeline(settings)
+,   _input(getHistoryCapacity(settings, _onsetGeometry))
+,   _filtered(_pipeline.equalizesLoudness() ? getHistoryCapacity(settings, _onsetGeometry) : 1)
+{
+    jassert (0.0 < settings.analysis.sampleRate);
+    _weights = {
+        static_cast<Real>(settings.onset.weight_hfc),
+        static_cast<Real>(settings.onset.weight_complex),
+        static_cast<Real>(settings.onset.weight_complexPhase),
+        static_cast<Real>(settings.onset.weight_flux),
+        static_cast<Real>(settings.onset.weight_rms)
+    };
+    _weightSum = std::accumulate(_weights.begin(), _weights.end(), 0.f);
+    jassert (_weightSum > 0.f);
+
+    const double frameSeconds = static_cast<double>(_onsetGeometry.hopSize) / settings.analysis.sampleRate;
+    _maxDecayPerFrame = static_cast<Real>(std::pow(0.5, frameSeconds / runningMaxHalfLifeSeconds));
+    const auto pickerWindow = static_cast<size_t>(2 * getOnsetLookahead(settings) + 1);
+    _combined.assign(pickerWindow, 0.f);
+    _pickerScratch.resize(pickerWindow);
+
+    if (_pipeline.equalizesLoudness()) {    // not when loudness is not requested
+        _equalLoudness = std::unique_ptr<standard::Algorithm>(standardFactory::create(
+                "EqualLoudness",
+                "sampleRate", static_cast<Real>(settings.analysis.sampleRate)
+                ));
+    }
+    _block.reserve(readBlockSize);
+    _filteredBlock.reserve(readBlockSize);
+}
+
+int LiveAnalyzer::pushAudio(const float *samples, const int numSamples) {
+    int start1, size1, start2, size2;
+    _fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    std::copy_n(samples, size1, _fifoBuffer.data() + start1);
+    std::copy_n(samples + size1, size2, _fifoBuffer.data() + start2);
+    const int numWritten = size1 + size2;
+    _fifo.finishedWrite(numWritten);
+    if (numWritten < numSamples) {
+        _numDropped.fetch_add(numSamples - numWritten);
+    }
+    return numWritten;
+}
+
+void LiveAnalyzer::process() {
+    while (_fifo.getNumReady() > 0) {
+        int start1, size1, start2, size2;
+        _fifo.prepareToRead(readBlockSize, start1, size1, start2, size2);
+        _block.assign(_fifoBuffer.data() + start1, _fifoBuffer.data() + start1 + size1);
+        _block.insert(_block.end(), _fifoBuffer.data() + start2, _fifoBuffer.data() + start2 + size2);
+        _fifo.finishedRead(size1 + size2);
+        analyzeBlock();
+    }
+}
+
+void LiveAnalyzer::flush() {
+    process();
+    if (_eventStart.has_value()) {
+        closeEvent(_input.end());
+    }
+}
+
+juce::int64 LiveAnalyzer::getLatencyInSamples() const {
+    // an onset frame is decided once the lookahead frames after it have been detected; the event it closes is then
+    // emitted right away. audio is consumed a read block at a time.
+    return getOnsetLookahead(_settings) * _onsetGeometry.hopSize + _onsetGeometry.frameSize - getHalfFrame(_onsetGeometry)
+        + readBlockSize;
+}
+
+void LiveAnalyzer::analyzeBlock() {
+    _input.append(_block);
+    if (_equalLoudness) {
+        // the filter keeps its state between blocks
+        _equalLoudness->input("signal").set(_block);
+        _equalLoudness->output("signal").set(_filteredBlock);
+        _equalLoudness->compute();
+        _filtered.append(_filteredBlock);
+    }
+
+    const juce::int64 hop = _onsetGeometry.hopSize;
+    const juce::int64 frameEndOffset = _onsetGeometry.frameSize - getHalfFrame(_onsetGeometry);
+    while (_nextOnsetFrame * hop + frameEndOffset <= _input.end()) {
+        if (const auto onsetSample = detectNextOnsetFrame()) {
+            if (_eventStart.has_value()) {
+                closeEvent(*onsetSample);
+            }
+            _eventStart = *onsetSample;
+            _nextEventFrame = *onsetSample;
+            _pipeline.beginEvent();
+        }
+        if (_eventStart.has_value()) {
+            // frames (and the fade-out that could follow them) lying wholly before the decided range are final
+            commitEventFrames(_decidedUpTo - _settings.analysis.frameSize - _settings.split.fadeOutSamps + 1, std::nullopt);
+        }
+    }
+}
+
+std::optional<juce::int64> LiveAnalyzer::detectNextOnsetFrame() {
+    const juce::int64 hop = _onsetGeometry.hopSize;
+    const auto k = _nextOnsetFrame++;
+    _onsetFrame.resize(static_cast<size_t>(_onsetGeometry.frameSize));
+    _input.copy(k * hop - getHalfFrame(_onsetGeometry), _onsetFrame.size(), _onsetFrame.data());
+    const auto values = _onsetKernel.processFrame(_onsetFrame);
+
+    // weighted sum of the detection functions, each normalized by its (slowly forgotten) running maximum
+    Real combined {0.f};
+    for (size_t i = 0; i < values.size(); ++i) {
+        _runningMax[i] = std::max(_runningMax[i] * _maxDecayPerFrame, values[i]);
+        if (_runningMax[i] > 0.f) {
+            combined += _weights[i] * values[i] / _runningMax[i];
+        }
+    }
+    if (_weightSum > 0.f) {
+        combined /= _weightSum;
+    }
+    const auto window = static_cast<juce::int64>(_combined.size());
+    const auto lookahead = window / 2;
+    _combined[static_cast<size_t>(k % window)] = combined;
+    if (k < lookahead) {
+        return std::nullopt;
+    }
+
+    // decide the frame `lookahead` frames back: a peak over its neighbourhood, above silence and above the
+    // neighbourhood's median plus alpha times its mean
+    const auto j = k - lookahead;
+    _decidedUpTo = (j + 1) * hop;
+    const Real candidate = _combined[static_cast<size_t>(j % window)];
+    std::ranges::copy(_combined, _pickerScratch.begin());
+    if (candidate < *std::ranges::max_element(_pickerScratch) || candidate <= _settings.onset.silenceThreshold) {
+        return std::nullopt;
+    }
+    const Real mean = std::accumulate(_pickerScratch.begin(), _pickerScratch.end(), 0.f) / static_cast<Real>(window);
+    const auto middle = _pickerScratch.begin() + lookahead;
+    std::nth_element(_pickerScratch.begin(), middle, _pickerScratch.end());
+    if (candidate <= *middle + static_cast<Real>(_settings.onset.alpha) * mean) {
+        return std::nullopt;
+    }
+
+    const auto onsetSample = j * hop;
+    const auto minimumDelta = static_cast<juce::int64>(minimumOnsetDeltaSeconds * _settings.analysis.sampleRate);
+    if (_lastOnsetSample >= 0 && onsetSample - _lastOnsetSample < minimumDelta) {
+        return std::nullopt;
+    }
+    _lastOnsetSample = onsetSample;
+    return onsetSample;
+}
+
+void LiveAnalyzer::commitEventFrames(const juce::int64 before, const std::optional<juce::int64> eventEnd) {
+    while (_nextEventFrame < before) {
+        cutEventFrame(_input, _nextEventFrame, eventEnd, _eventFrame);
+        if (_equalLoudness) {
+            cutEventFrame(_filtered, _nextEventFrame, eventEnd, _loudnessFrame);
+        }
+        _pipeline.pushFrame(_eventFrame, _equalLoudness ? &_loudnessFrame : nullptr);
+        _nextEventFrame += _settings.analysis.hopSize;
+    }
+}
+
+void LiveAnalyzer::cutEventFrame(SampleHistory const &history, const juce::int64 frameStart,
+                                 const std::optional<juce::int64> eventEnd, vecReal &frame) const
+{
+    // as EventFrameCutter: zero-padded past the event's end, with the split fades. while the event is open, the frame
+    // lies wholly before its end, so only the fade-in can apply.
+    const auto eventStart = _eventStart.value();
+    const auto frameSize = static_cast<juce::int64>(_settings.analysis.frameSize);
+    const auto numValid = eventEnd.has_value() ? std::clamp<juce::int64>(*eventEnd - frameStart, 0, frameSize) : frameSize;
+    frame.assign(static_cast<size_t>(frameSize), 0.f);
+    history.copy(frameStart, static_cast<size_t>(numValid), frame.data());
+
+    const size_t length = eventEnd.has_value() ? static_cast<size_t>(*eventEnd - eventStart) : std::numeric_limits<size_t>::max();
+    const size_t fadeInSamps = std::min(static_cast<size_t>(_settings.split.fadeInSamps), length);
+    const size_t fadeOutSamps = eventEnd.has_value() ? std::min(static_cast<size_t>(_settings.split.fadeOutSamps), length) : 0;
+    for (juce::int64 i = 0; i < numValid; ++i) {
+        const auto idx = static_cast<size_t>(frameStart - eventStart + i);
+        if (idx < fadeInSamps || length - 1 - idx < fadeOutSamps) {
+            frame[static_cast<size_t>(i)] *= fadeGain(idx, length, fadeInSamps, fadeOutSamps);
+        }
+    }
+}
+
+void LiveAnalyzer::closeEvent(const juce::int64 eventEnd) {
+    const auto eventStart = _eventStart.value();
+    commitEventFrames(eventEnd, eventEnd);
+    _eventStart.reset();
+    if (_onEvent) {
+        _onEvent(Event{ eventStart, eventEnd - eventStart, _pipeline.endEvent() });
+    }
+}
+
+}   // namespace nvs::analysis
@@ -0,0 +1,112 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include "AnalysisUsing.h"
+#include "Settings.h"
+#include "Features.h"
+#include "Statistics.h"
+#include "OnsetAnalysis/OnsetDetectionKernel.h"
+#include "TimbreAnalysis/EventFramePipeline.h"
+
+namespace nvs::analysis {
+
+/**
+ * Onset detection and eventwise description of a live stream, at bounded latency and in constant memory.
+ * An audio thread pushes blocks with pushAudio (lock-free, single producer); an analysis thread calls process, which
+ * detects onsets in the new audio and feeds each event's frames to an EventFramePipeline as soon as no onset can cut
+ * them short, emitting the event's statistics once the next onset closes it. Only the last few frames of audio are
+ * kept, however long the stream runs.
+ *
+ * Differences from the offline Analyzer, all forced by not seeing the whole file:
+ * - onsets are picked causally, with numFrames_shortOnsetFilter frames of lookahead, and each detection function is
+ *   normalized by a decaying running maximum rather than its maximum over the file
+ * - onset detection runs at the stream's own rate (as with RateConversion::Native)
+ * - equal-loudness filtering runs over the continuous stream rather than each faded event
+ */
+class LiveAnalyzer {
+public:
+    struct Event {
+        juce::int64 startSample {0};        // since the start of the stream
+        juce::int64 lengthInSamples {0};
+        FeatureContainer<EventwiseStatistics<Real>> features;
+    };
+    using EventCallback = std::function<void(Event const &)>;
+
+    LiveAnalyzer(AnalyzerSettings const &settings, EventCallback onEvent, int fifoSizeInSamples = 1 << 16);
+
+    // audio thread: copies the samples into the FIFO, without locking or allocating. returns how many were accepted;
+    // the rest are dropped (and counted) when the analysis thread has fallen a whole FIFO behind.
+    int pushAudio(const float *samples, int numSamples);
+    // audio thread: how many samples pushAudio would accept right now
+    int getFreeSpace() const { return _fifo.getFreeSpace(); }
+
+    // analysis thread: analyzes everything pushed so far, calling onEvent for each event an onset closed
+    void process();
+    // analysis thread: once the stream has ended, closes the open event at the last sample and emits it
+    void flush();
+
+    // the most samples between an onset and the moment it is detected (and the previous event emitted)
+    juce::int64 getLatencyInSamples() const;
+    juce::int64 getNumDroppedSamples() const { return _numDropped.load(); }
+    juce::int64 getNumSamplesAnalyzed() const { return _input.end(); }
+
+private:
+    // the most recent samples of the stream, addressed by their index since its start
+    class SampleHistory {
+    public:
+        explicit SampleHistory(const size_t capacity) : _buffer(capacity, 0.f) {}
+        void append(std::span<const Real> samples);
+        // copies [start, start + n) into dest. indices before the start of the stream read as silence.
+        void copy(juce::int64 start, size_t n, Real *dest) const;
+        juce::int64 end() const { return _end; }
+    private:
+        std::vector<Real> _buffer;
+        juce::int64 _end {0};
+    };
+
+    nvs::ess::EssentiaInitializer _essentiaInit;     // before any member that creates algorithms
+    AnalyzerSettings const _settings;
+    EventCallback _onEvent;
+
+    juce::AbstractFifo _fifo;
+    std::vector<float> _fifoBuffer;
+    std::atomic<juce::int64> _numDropped {0};
+    vecReal _block, _filteredBlock;
+
+    // onset detection
+    OnsetFrameGeometry const _onsetGeometry;
+    OnsetDetectionKernel _onsetKernel;
+    vecReal _onsetFrame;
+    juce::int64 _nextOnsetFrame {0};
+    std::array<Real, OnsetDetectionKernel::numDetectionFunctions> _weights {}, _runningMax {};
+    Real _weightSum {0.f}, _maxDecayPerFrame {1.f};
+    std::vector<Real> _combined, _pickerScratch;    // last 2 * lookahead + 1 combined values, by frame % size
+    juce::int64 _lastOnsetSample {-1};
+    juce::int64 _decidedUpTo {0};       // no onset can still be found before this sample
+
+    // event description
+    EventFramePipeline _pipeline;
+    std::unique_ptr<standard::Algorithm> _equalLoudness;
+    SampleHistory _input, _filtered;
+    std::optional<juce::int64> _eventStart;
+    juce::int64 _nextEventFrame {0};
+    vecReal _eventFrame, _loudnessFrame;
+
+    void analyzeBlock();
+    std::optional<juce::int64> detectNextOnsetFrame();
+    void commitEventFrames(juce::int64 before, std::optional<juce::int64> eventEnd);
+    void cutEventFrame(SampleHistory const &history, juce::int64 frameStart, std::optional<juce::int64> eventEnd,
+                       vecReal &frame) const;
+    void closeEvent(juce::int64 eventEnd);
+};
+
+}   // namespace nvs::analysis
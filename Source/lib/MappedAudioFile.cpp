@@ -0,0 +1,87 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "MappedAudioFile.h"
+#include <cstring>
+#include <optional>
+
+namespace nvs::analysis {
+
+namespace {
+
+struct WavDataChunk {
+    size_t offset {0};      // bytes from the start of the file
+    size_t size {0};
+};
+
+// the data chunk of a RIFF WAVE file holding mono 32-bit IEEE float samples, if it is one
+std::optional<WavDataChunk> findMonoFloatWavData(const juce::MemoryMappedFile &mapping) {
+    const auto *bytes = static_cast<const char *>(mapping.getData());
+    const auto fileSize = mapping.getSize();
+    if (bytes == nullptr || fileSize < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0) {
+        return std::nullopt;
+    }
+    constexpr unsigned short pcmFloat {3}, extensible {0xfffe};
+    bool monoFloat {false};
+    for (size_t pos = 12; pos + 8 <= fileSize; ) {
+        const char *chunk = bytes + pos;
+        const size_t chunkSize = juce::ByteOrder::littleEndianInt(chunk + 4);
+        const char *body = chunk + 8;
+        if (pos + 8 + chunkSize > fileSize) {
+            break;
+        }
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16) {
+            auto format = juce::ByteOrder::littleEndianShort(body);
+            if (format == extensible && chunkSize >= 26) {
+                format = juce::ByteOrder::littleEndianShort(body + 24);  // the start of the sub-format GUID
+            }
+            const auto numChannels = juce::ByteOrder::littleEndianShort(body + 2);
+            const auto bitsPerSample = juce::ByteOrder::littleEndianShort(body + 14);
+            monoFloat = format == pcmFloat && numChannels == 1 && bitsPerSample == 32;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!monoFloat) {
+                return std::nullopt;
+            }
+            return WavDataChunk{ pos + 8, chunkSize };
+        }
+        pos += 8 + chunkSize + (chunkSize & 1);     // chunks are padded to an even size
+    }
+    return std::nullopt;
+}
+
+}   // anonymous namespace
+
+std::unique_ptr<MappedAudioFile> MappedAudioFile::open(const juce::File &file) {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    auto *format = formatManager.findFormatForFileExtension(file.getFileExtension());
+    if (format == nullptr) {
+        return nullptr;
+    }
+    // only the uncompressed formats can be read from a mapping
+    auto reader = std::unique_ptr<juce::MemoryMappedAudioFormatReader>(format->createMemoryMappedReader(file));
+    if (reader == nullptr || !reader->mapEntireFile()) {
+        return nullptr;
+    }
+
+    auto mapped = std::unique_ptr<MappedAudioFile>(new MappedAudioFile());
+    mapped->_reader = std::move(reader);
+
+#if JUCE_LITTLE_ENDIAN
+    if (format->getFormatName() == juce::WavAudioFormat().getFormatName()) {
+        auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        if (const auto data = findMonoFloatWavData(*mapping);
+            data.has_value() && data->offset % alignof(float) == 0)   // the mapping itself starts page-aligned
+        {
+            const auto *samples = reinterpret_cast<const float *>(static_cast<const char *>(mapping->getData()) + data->offset);
+            const auto numSamples = std::min(data->size / sizeof(float), static_cast<size_t>(mapped->getLengthInSamples()));
+            mapped->_floatSamples = std::span<const float>(samples, numSamples);
+            mapped->_floatMapping = std::move(mapping);
+        }
+    }
+#endif
+    return mapped;
+}
+
+}   // namespace nvs::analysis
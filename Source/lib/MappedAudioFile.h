@@ -0,0 +1,40 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <memory>
+#include <span>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace nvs::analysis {
+
+/**
+ * An uncompressed WAV or AIFF file mapped into memory rather than read through the file system, so opening it costs
+ * nothing up front and processes analyzing the same corpus share its pages in the OS cache.
+ * Mono 32-bit float WAV data is exposed in place; anything else is converted to float a chunk at a time, as it is
+ * read from the mapped memory.
+ */
+class MappedAudioFile {
+public:
+    // nullptr if the file is not uncompressed WAV or AIFF, or could not be mapped
+    static std::unique_ptr<MappedAudioFile> open(const juce::File &file);
+
+    // reads from the mapping, converting only the samples asked for
+    juce::AudioFormatReader &getReader() { return *_reader; }
+    // the samples themselves, if the file is mono 32-bit float WAV (and the host little-endian); empty otherwise
+    std::span<const float> getFloatSamples() const { return _floatSamples; }
+
+    juce::int64 getLengthInSamples() const { return _reader->lengthInSamples; }
+    double getSampleRate() const { return _reader->sampleRate; }
+
+private:
+    MappedAudioFile() = default;
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> _reader;
+    std::unique_ptr<juce::MemoryMappedFile> _floatMapping;
+    std::span<const float> _floatSamples;
+};
+
+}   // namespace nvs::analysis
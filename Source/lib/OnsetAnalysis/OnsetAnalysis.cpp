@@ -9,6 +9,12 @@
 */
 
 #include "OnsetAnalysis.h"
+#include "OnsetDetectionKernel.h"
+#include "../SpectralFrontEnd.h"
+#include "../TimbreAnalysis/BatchBFCC.h"
+#include <array>
+#include <cmath>
+#include <numeric>
 
 /** TODO:
  consolidate onsetsInSeconds with onsetAnalysis.
@@ -35,37 +41,130 @@ static vecReal getWeights(const AnalyzerSettings &settings) {
         static_cast<float>(settings.onset.weight_rms)
     };
 }
-array2dReal calculateOnsetsMatrix(std::vector<Real> const &waveform,
-						  streamingFactory const &factory,
-						  AnalyzerSettings const &settings,
-						  RunLoopStatus& rls,
-						  const ShouldExitFn &shouldExit)
+
+// the onset parameters (alpha, delay, silenceThreshold) were tuned at this rate and hop
+constexpr auto onsetReferenceSampleRate = 44100.0f;
+constexpr int onsetReferenceHopSize = 512;
+
+OnsetFrameGeometry getOnsetFrameGeometry(const AnalyzerSettings &settings) {
+	using RateConversion = AnalyzerSettings::Onset::RateConversion;
+	const auto fileSampleRate = static_cast<Real>(settings.analysis.sampleRate);
+	assert (0.f < fileSampleRate);
+
+	OnsetFrameGeometry geometry;
+	geometry.frameSize = std::min(std::max(512, settings.analysis.frameSize), 2048);
+	geometry.hopSize = onsetReferenceHopSize;
+	geometry.sampleRate = onsetReferenceSampleRate;
+
+	if (settings.onset.rateConversion == RateConversion::Resample) {
+		geometry.resample = (fileSampleRate != onsetReferenceSampleRate);
+		return geometry;
+	}
+	if (settings.onset.rateConversion == RateConversion::Decimate) {
+		geometry.decimation = std::max(1, static_cast<int>(fileSampleRate / onsetReferenceSampleRate));
+	}
+	geometry.sampleRate = fileSampleRate / static_cast<Real>(geometry.decimation);
+	// scale hop and frame by a power of two, so the frames span about as much time as at 44.1 kHz and stay FFT-friendly
+	const int octaves = static_cast<int>(std::lround(std::log2(geometry.sampleRate / onsetReferenceSampleRate)));
+	geometry.hopSize = std::max(64, static_cast<int>(std::ldexp(onsetReferenceHopSize, octaves)));
+	geometry.frameSize = std::max(geometry.hopSize, static_cast<int>(std::ldexp(geometry.frameSize, octaves)));
+	return geometry;
+}
+
+namespace {
+// zeroth-order modified Bessel function of the first kind, for the Kaiser window
+double besselI0(const double x) {
+	double sum {1.0}, term {1.0};
+	for (int k = 1; k < 50 && term > 1e-12 * sum; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+}	// anonymous namespace
+
+vecReal decimate(const std::span<Real const> signal, const int factor) {
+	assert (0 < factor);
+	if (factor == 1) {
+		return {signal.begin(), signal.end()};
+	}
+	// Kaiser-windowed sinc lowpass (Kaiser's design formulas): passband to 80% of the output Nyquist, stopband from the
+	// output Nyquist on, so everything that folds back into the output band is attenuated. designed for 65 dB, as the
+	// formulas land a little short; measured at least 60 dB down (about 20 taps per output sample on each side)
+	constexpr double stopbandDB {65.0};
+	const double passbandEdge = 0.4 / factor;	// cycles per input sample
+	const double stopbandEdge = 0.5 / factor;
+	const double cutoff = 0.5 * (passbandEdge + stopbandEdge);
+	const double beta = 0.1102 * (stopbandDB - 8.7);
+	const double transitionWidth = juce::MathConstants<double>::twoPi * (stopbandEdge - passbandEdge);	// radians per sample
+	const int halfLength = static_cast<int>(std::ceil((stopbandDB - 8.0) / (2.285 * transitionWidth) / 2.0));
+	std::vector<Real> taps(static_cast<size_t>(2 * halfLength + 1));
+	double tapSum {0.0};
+	for (int k = -halfLength; k <= halfLength; ++k) {
+		const auto x = static_cast<double>(k);
+		const double sinc = (k == 0) ? 2.0 * cutoff
+		                             : std::sin(juce::MathConstants<double>::twoPi * cutoff * x) / (juce::MathConstants<double>::pi * x);
+		const double r = x / halfLength;
+		const double window = besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+		taps[static_cast<size_t>(k + halfLength)] = static_cast<Real>(sinc * window);
+		tapSum += sinc * window;
+	}
+	for (auto &t : taps) {
+		t = static_cast<Real>(t / tapSum);	// unity gain at DC
+	}
+
+	// only every factor-th output is computed; output n is centered on input n * factor, so timing is unchanged
+	const auto numIn = static_cast<std::ptrdiff_t>(signal.size());
+	vecReal out((signal.size() + static_cast<size_t>(factor) - 1) / static_cast<size_t>(factor));
+	for (size_t n = 0; n < out.size(); ++n) {
+		const auto center = static_cast<std::ptrdiff_t>(n) * factor;
+		const auto first = std::max<std::ptrdiff_t>(0, center - halfLength);
+		const auto last = std::min<std::ptrdiff_t>(numIn - 1, center + halfLength);
+		const Real *x = signal.data() + first;
+		const Real *h = taps.data() + (first - (center - halfLength));
+		Real acc {0.f};
+		for (std::ptrdiff_t i = 0; i <= last - first; ++i) {
+			acc += x[i] * h[i];		// the filter is symmetric, so no reversal is needed
+		}
+		out[n] = acc;
+	}
+	return out;
+}
+
+namespace {
+
+constexpr size_t numDetectionFunctions = OnsetDetectionKernel::numDetectionFunctions;
+
+using DetectionFunctions = OnsetDetectionKernel::DetectionFunctions;
+
+Algorithm *createOnsetResampler(streamingFactory const &factory, const AnalyzerSettings &settings) {
+	return factory.create("Resample",
+						  "inputSampleRate", settings.analysis.sampleRate,
+						  "outputSampleRate", onsetReferenceSampleRate,
+						  "quality",	2);	/* quality: SRC_SINC_FASTEST
+											 from enum {
+													   SRC_SINC_BEST_QUALITY       = 0,
+													   SRC_SINC_MEDIUM_QUALITY     = 1,
+													   SRC_SINC_FASTEST            = 2,
+													   SRC_ZERO_ORDER_HOLD         = 3,
+													   SRC_LINEAR                  = 4
+												   } ;
+											 */
+}
+
+bool needsConversion(const OnsetFrameGeometry &geometry) {
+	return geometry.resample || geometry.decimation > 1;
+}
+
+// FrameCutter -> Windowing -> FFT -> CartesianToPolar -> all five OnsetDetection methods, fed from source.
+// the first frame is centered on the source's first sample.
+void connectOnsetDetectionChain(SourceBase &source, streamingFactory const &factory, const OnsetFrameGeometry &geometry,
+								DetectionFunctions &detections)
 {
-	const auto input_sr     = settings.analysis.sampleRate;
-	assert(0.0 < input_sr);
-    constexpr auto internal_sr  = 44100.0f;
-	const auto frameSize    = std::min(std::max(512, settings.analysis.frameSize), 2048);
-	constexpr auto hopSize      = 512;
-
-	auto *inVec = new vectorInput(&waveform);
-
-	Algorithm* resampler	= factory.create("Resample",
-											 "inputSampleRate", input_sr,
-											 "outputSampleRate", internal_sr,
-											 "quality",	2);	/* quality: SRC_SINC_FASTEST
-															 from enum {
-																	   SRC_SINC_BEST_QUALITY       = 0,
-																	   SRC_SINC_MEDIUM_QUALITY     = 1,
-																	   SRC_SINC_FASTEST            = 2,
-																	   SRC_ZERO_ORDER_HOLD         = 3,
-																	   SRC_LINEAR                  = 4
-																   } ;
-															 */
-
-	// ============ Main processing chain (variable frameSize) ============
+	const int frameSize = geometry.frameSize;
 	Algorithm* frameCutter  = factory.create("FrameCutter",
 											 "frameSize", frameSize,
-											 "hopSize", hopSize,
+											 "hopSize", geometry.hopSize,
 											 "startFromZero", false,
 											 "lastFrameToEndOfFile", true,
 											 "validFrameThresholdRatio", 0.0f);
@@ -82,118 +181,226 @@ array2dReal calculateOnsetsMatrix(std::vector<Real> const &waveform,
 
 	Algorithm* carToPol		= factory.create("CartesianToPolar");
 
-    // ============ Connect beginning of chain (independent of which onset detectors are used) ============
-    *inVec >> resampler->input("signal");
-    resampler->output("signal") >> frameCutter->input("signal");
+    source >> frameCutter->input("signal");
     frameCutter->output("frame") >> windowingToFFT->input("frame");
     windowingToFFT->output("frame") >> FFT->input("frame");
     FFT->output("fft") >> carToPol->input("complex");
 
-
-	// ============ Connect individual onset detection algorithms ============
-    vecReal onsetDetVecHFC, onsetDetVecComplex, onsetDetVecComplexPhase, onsetDetVecFlux, onsetDetVecRms;
-    std::vector<std::reference_wrapper<vecReal>> detectionRefs {
-        onsetDetVecHFC,
-        onsetDetVecComplex,
-        onsetDetVecComplexPhase,
-        onsetDetVecFlux,
-        onsetDetVecRms
-    };
-
-    const auto weights = getWeights(settings);
-
-    if (const auto weightSum = std::accumulate(weights.begin(), weights.end(), 0.f);
-        weightSum == 0.f)
-    {
-        jassertfalse;
-        // handle case where user asked for cumulative weight of 0
-    }
-
-    if (0.f < settings.onset.weight_hfc) {
-        Algorithm* onsetDetectionHfc = factory.create("OnsetDetection",
-                                                "method", "hfc",
-                                                   "sampleRate", internal_sr);
-        carToPol->output("magnitude") >> onsetDetectionHfc->input("spectrum");
-        carToPol->output("phase")	>> onsetDetectionHfc->input("phase");
-        auto *onsetDetsHFC = new vectorOutput(&onsetDetVecHFC);
-        onsetDetectionHfc->output("onsetDetection") >> *onsetDetsHFC;
-    }
-    if (0.f < settings.onset.weight_complex) {
-        Algorithm* onsetDetectionComplex = factory.create("OnsetDetection",
-                                                "method", "complex",
-                                                   "sampleRate", internal_sr);
-        carToPol->output("magnitude") >> onsetDetectionComplex->input("spectrum");
-        carToPol->output("phase")	>> onsetDetectionComplex->input("phase");
-        auto *onsetDetsComplex = new vectorOutput(&onsetDetVecComplex);
-        onsetDetectionComplex->output("onsetDetection") >> *onsetDetsComplex;
-    }
-    if (0.f < settings.onset.weight_complexPhase) {
-        Algorithm* onsetDetectionComplexPhase = factory.create("OnsetDetection",
-                                                "method", "complex_phase",
-                                                   "sampleRate", internal_sr);
-        carToPol->output("magnitude") >> onsetDetectionComplexPhase->input("spectrum");
-        carToPol->output("phase")	>> onsetDetectionComplexPhase->input("phase");
-        auto *onsetDetsComplexPhase = new vectorOutput(&onsetDetVecComplexPhase);
-        onsetDetectionComplexPhase->output("onsetDetection") >> *onsetDetsComplexPhase;
-    }
-    if (0.f < settings.onset.weight_flux) {
-        Algorithm* onsetDetectionFlux = factory.create("OnsetDetection",
-                                                "method", "flux",
-                                                   "sampleRate", internal_sr);
-        carToPol->output("magnitude") >> onsetDetectionFlux->input("spectrum");
-        carToPol->output("phase")	>> onsetDetectionFlux->input("phase");
-        auto *onsetDetsFlux = new vectorOutput(&onsetDetVecFlux);
-        onsetDetectionFlux->output("onsetDetection") >> *onsetDetsFlux;
-    }
-    if (0.f < settings.onset.weight_rms) {
-        Algorithm* onsetDetectionRms = factory.create("OnsetDetection",
-                                                "method", "rms",
-                                                   "sampleRate", internal_sr);
-        auto *onsetDetsRms = new vectorOutput(&onsetDetVecRms);
-        carToPol->output("magnitude") >> onsetDetectionRms->input("spectrum");
-        carToPol->output("phase")	>> onsetDetectionRms->input("phase");
-        onsetDetectionRms->output("onsetDetection") >> *onsetDetsRms;
+    // every detection function is computed regardless of its weight: they share one FFT, and having all five lets
+    // onsets be re-picked from the same matrix with any weights (see onsetDetectionKey)
+    constexpr std::array<const char *, numDetectionFunctions> methods {"hfc", "complex", "complex_phase", "flux", "rms"};
+    for (size_t i = 0; i < numDetectionFunctions; ++i) {
+        Algorithm* onsetDetection = factory.create("OnsetDetection",
+                                                   "method", methods[i],
+                                                   "sampleRate", geometry.sampleRate);
+        carToPol->output("magnitude") >> onsetDetection->input("spectrum");
+        carToPol->output("phase")	>> onsetDetection->input("phase");
+        auto *onsetDets = new vectorOutput(&detections[i]);
+        onsetDetection->output("onsetDetection") >> *onsetDets;
     }
+}
 
+// returns false if stopped early
+bool runNetwork(vectorInput *inVec, const ShouldExitFn &shouldExit) {
 	Network n(inVec);
 	n.runPrepare();
-	rls.set(0.0);
-	rls.set("Computing onset matrix...");
 	while (n.runStep()){
 		if (shouldExit()) {
-			break;
+			n.clear();
+			return false;
 		}
 	}
-	rls.set(1.0);
 	n.clear();
+	return true;
+}
 
-    // this bit just takes all the detection outputs and makes them constant-size (which should only not happen if some of them had a weight of 0)
-    const auto correctSizedVec = std::ranges::max_element(detectionRefs,
-                                                          [](const vecReal &v0, const vecReal &v1)
-                                                          {
-                                                              return v0.size() < v1.size();
-                                                          });
-    const size_t correctSize = correctSizedVec->get().size();
+// resamples or decimates waveform into converted, as geometry says. returns false if stopped early
+bool convertOnsetSignal(const vecReal &waveform, streamingFactory const &factory, const AnalyzerSettings &settings,
+						const OnsetFrameGeometry &geometry, vecReal &converted, const ShouldExitFn &shouldExit)
+{
+	if (geometry.resample) {
+		auto *inVec = new vectorInput(&waveform);
+		Algorithm* resampler = createOnsetResampler(factory, settings);
+		auto *resampledOut = new vectorOutput(&converted);
+		*inVec >> resampler->input("signal");
+		resampler->output("signal") >> *resampledOut;
+		return runNetwork(inVec, shouldExit);
+	}
+	if (geometry.decimation > 1) {
+		converted = decimate(waveform, geometry.decimation);
+	}
+	return true;
+}
 
+array2dReal toOnsetsMatrix(const DetectionFunctions &detections) {
+    const size_t correctSize = detections[0].size();
     jassert (0 < correctSize);
-    for (auto d : detectionRefs) {
-        if (d.get().empty()) {
-            d.get() = vecReal(correctSize, 0.f);
-        }
-        jassert (d.get().size() == correctSize);
+    for (auto const &d : detections) {
+        jassert (d.size() == correctSize);
     }
 
-	TNT::Array2D<essentia::Real> onsetsMatrix(5, static_cast<int>(correctSize));
-	for (size_t j = 0; j < correctSize; ++j){
-		onsetsMatrix[0][j] = onsetDetVecHFC[j];
-		onsetsMatrix[1][j] = onsetDetVecComplex[j];
-		onsetsMatrix[2][j] = onsetDetVecComplexPhase[j];
-		onsetsMatrix[3][j] = onsetDetVecFlux[j];
-		onsetsMatrix[4][j] = onsetDetVecRms[j];
+	TNT::Array2D<essentia::Real> onsetsMatrix(numDetectionFunctions, static_cast<int>(correctSize));
+	for (size_t i = 0; i < numDetectionFunctions; ++i) {
+		std::copy(detections[i].begin(), detections[i].end(), onsetsMatrix[static_cast<int>(i)]);
 	}
 	return onsetsMatrix;
 }
 
+}	// anonymous namespace
+
+array2dReal calculateOnsetsMatrix(std::vector<Real> const &waveform,
+						  streamingFactory const &factory,
+						  AnalyzerSettings const &settings,
+						  RunLoopStatus& rls,
+						  const ShouldExitFn &shouldExit)
+{
+	assert(0.0 < settings.analysis.sampleRate);
+	const auto geometry = getOnsetFrameGeometry(settings);
+
+	rls.set(0.0);
+	rls.set("Computing onset matrix...");
+
+	if (settings.onset.fusedDetection) {
+		vecReal converted;
+		if (!convertOnsetSignal(waveform, factory, settings, geometry, converted, shouldExit)) {
+			return {};
+		}
+		DetectionFunctions detections;
+		OnsetDetectionKernel kernel(geometry);
+		if (!kernel.process(needsConversion(geometry) ? converted : waveform, detections, shouldExit)) {
+			return {};
+		}
+		rls.set(1.0);
+		return toOnsetsMatrix(detections);
+	}
+
+	const vecReal decimated = (geometry.decimation > 1) ? decimate(waveform, geometry.decimation) : vecReal{};
+	auto *inVec = new vectorInput(geometry.decimation > 1 ? &decimated : &waveform);
+
+    DetectionFunctions detections;
+	if (geometry.resample) {
+		Algorithm* resampler = createOnsetResampler(factory, settings);
+		*inVec >> resampler->input("signal");
+		connectOnsetDetectionChain(resampler->output("signal"), factory, geometry, detections);
+	} else {
+		connectOnsetDetectionChain(inVec->output("data"), factory, geometry, detections);
+	}
+
+	if (!runNetwork(inVec, shouldExit)) {
+		return {};
+	}
+	rls.set(1.0);
+
+	return toOnsetsMatrix(detections);
+}
+
+array2dReal calculateOnsetsMatrixInChunks(std::vector<Real> const &waveform,
+										  streamingFactory const &factory,
+										  AnalyzerSettings const &settings,
+										  AnalysisScheduler &scheduler,
+										  RunLoopStatus& rls,
+										  const ShouldExitFn &shouldExit)
+{
+	assert(0.0 < settings.analysis.sampleRate);
+	const auto geometry = getOnsetFrameGeometry(settings);
+	rls.set(0.0);
+	rls.set("Computing onset matrix...");
+
+	// resampling or decimation runs once, serially, so no chunk has to reproduce the converter's state
+	vecReal converted;
+	if (!convertOnsetSignal(waveform, factory, settings, geometry, converted, shouldExit)) {
+		return {};
+	}
+	const vecReal &signal = needsConversion(geometry) ? converted : waveform;
+
+	const int frameSize = geometry.frameSize;
+	// frame k of the file is centered on sample k * hop
+	const auto halfFrame = static_cast<std::ptrdiff_t>((frameSize + 1) / 2);
+	const auto hop = static_cast<std::ptrdiff_t>(geometry.hopSize);
+	const auto numSamples = static_cast<std::ptrdiff_t>(signal.size());
+
+	// a chunk's slice starts at its first warm-up frame's center, so its first frames are zero-padded on the left
+	// (as the file's first frames are) and are dropped: that many, plus two for the detection functions that look
+	// back at previous frames (complex and complex_phase look two back, flux and rms one)
+	const size_t warmUpFrames = static_cast<size_t>((halfFrame + hop - 1) / hop) + 2;
+
+	// enough frames per chunk that the warm-up and per-network setup are negligible
+	constexpr size_t minFramesPerChunk {256};
+	const size_t approxNumFrames = signal.size() / static_cast<size_t>(geometry.hopSize) + 1;
+	const size_t numChunks = std::clamp<size_t>(approxNumFrames / minFramesPerChunk, 1, scheduler.getNumThreads() * 4);
+	const size_t framesPerChunk = (approxNumFrames + numChunks - 1) / numChunks;
+
+	std::vector<DetectionFunctions> chunkDetections(numChunks);
+	std::atomic<size_t> completed {0};
+	std::atomic<bool> cancelled {false};
+
+	scheduler.parallelFor(numChunks, [&](const size_t c, size_t) {
+		if (cancelled.load(std::memory_order_relaxed)) {
+			return;
+		}
+		const bool isLastChunk = (c + 1 == numChunks);
+		const size_t firstFrame = c * framesPerChunk;
+		const size_t warmStart = firstFrame > warmUpFrames ? firstFrame - warmUpFrames : 0;	// the first chunk is the file's start
+
+		const auto sliceBegin = static_cast<std::ptrdiff_t>(warmStart) * hop;
+		// past the last kept frame's end by one hop, so no kept frame is zero-padded on the right
+		const auto sliceEnd = isLastChunk ? numSamples
+			: std::min(numSamples, static_cast<std::ptrdiff_t>(firstFrame + framesPerChunk - 1) * hop - halfFrame + frameSize + hop);
+		if (sliceBegin >= sliceEnd) {
+			return;		// the frame estimate overshot, and this trailing chunk has no frames
+		}
+
+		const vecReal slice(signal.begin() + sliceBegin, signal.begin() + sliceEnd);
+		const ShouldExitFn isCancelled = [&] { return cancelled.load(std::memory_order_relaxed); };
+		DetectionFunctions detections;
+		if (settings.onset.fusedDetection) {
+			OnsetDetectionKernel kernel(geometry);
+			if (!kernel.process(slice, detections, isCancelled)) {
+				return;
+			}
+		} else {
+			auto *inVec = new vectorInput(&slice);
+			connectOnsetDetectionChain(inVec->output("data"), factory, geometry, detections);
+			if (!runNetwork(inVec, isCancelled)) {
+				return;
+			}
+		}
+
+		const size_t skip = firstFrame - warmStart;
+		for (size_t i = 0; i < numDetectionFunctions; ++i) {
+			auto &d = detections[i];
+			const size_t begin = std::min(skip, d.size());
+			const size_t end = isLastChunk ? d.size() : std::min(d.size(), begin + framesPerChunk);
+			chunkDetections[c][i].assign(d.begin() + static_cast<std::ptrdiff_t>(begin), d.begin() + static_cast<std::ptrdiff_t>(end));
+		}
+
+		rls.set(static_cast<double>(++completed) / static_cast<double>(numChunks));
+		if (shouldExit()) {
+			cancelled.store(true, std::memory_order_relaxed);
+		}
+	});
+	if (cancelled.load()) {
+		return {};
+	}
+
+	DetectionFunctions detections;
+	for (size_t i = 0; i < numDetectionFunctions; ++i) {
+		for (auto const &chunk : chunkDetections) {
+			detections[i].insert(detections[i].end(), chunk[i].begin(), chunk[i].end());
+		}
+	}
+	rls.set(1.0);
+	return toOnsetsMatrix(detections);
+}
+
+juce::String onsetDetectionKey(const AnalyzerSettings &settings) {
+	// all five detection functions are always computed, so the weights only matter when picking onsets
+	return "sampleRate=" + juce::String(settings.analysis.sampleRate)
+		+ ";frameSize=" + juce::String(settings.analysis.frameSize)
+		+ ";rateConversion=" + juce::String(static_cast<int>(settings.onset.rateConversion))
+		+ ";fusedDetection=" + juce::String(static_cast<int>(settings.onset.fusedDetection));
+}
+
 #pragma message("make this work with StreamingFactory")
 vecReal calculateOnsetsInSeconds(const array2dReal &onsetAnalysisMatrix,
 								 const standardFactory &factory,
@@ -201,20 +408,26 @@ vecReal calculateOnsetsInSeconds(const array2dReal &onsetAnalysisMatrix,
 {
 	/* assuming that the onsetAnalysisMatrix was derived from the above onsetAnalysis,
 	 (which is beyond likely in this codebase because it's not so trivial to construct that array2dReal),
-	 the sample rate of the signal will have already been converted to 44100 before the analysis.
+	 its frames are spaced as getOnsetFrameGeometry says for these settings.
 	 */
 
-	constexpr float frameRate = 44100.f / 512.f;
+	const float frameRate = getOnsetFrameGeometry(settings).frameRate();
 
-	essentia::standard::Algorithm* onsetDetectionSeconds = factory.create (
+	const auto onsetDetectionSeconds = std::unique_ptr<essentia::standard::Algorithm>(factory.create (
 		"Onsets",
 		  "frameRate",       frameRate,
 		  "silenceThreshold",settings.onset.silenceThreshold,
 		  "alpha",           settings.onset.alpha, // proportion of the mean included to reject smaller peaks-filters very short onsets
 		  "delay",           settings.onset.numFrames_shortOnsetFilter // number of frames used to compute the threshold-size of short-onset filter
-	);
+	));
 
     const vecReal weights = getWeights(settings);
+    if (const auto weightSum = std::accumulate(weights.begin(), weights.end(), 0.f);
+        weightSum == 0.f)
+    {
+        jassertfalse;
+        // handle case where user asked for cumulative weight of 0
+    }
 
 	vecReal onsets;
 	onsetDetectionSeconds->input("detections").set(onsetAnalysisMatrix);
@@ -231,15 +444,12 @@ vecReal calculateOnsetsInSeconds(const array2dReal &onsetAnalysisMatrix,
 }
 
 vecVecReal featuresForSbic(const vecReal &waveform,
-						   const AlgorithmFactory &factory,
+						   [[maybe_unused]] const AlgorithmFactory &factory,
 						   const AnalyzerSettings &settings,
-						   RunLoopStatus& rls,
+						   [[maybe_unused]] RunLoopStatus& rls,
 						   const ShouldExitFn &shouldExit)
 {
-	auto *inVec = new vectorInput(&waveform);
-
-    const auto sr = static_cast<float>(settings.analysis.sampleRate);
-	assert (0.0 < sr);
+	assert (0.0 < settings.analysis.sampleRate);
 	int const frameSize = settings.analysis.frameSize;
 	int const hopSize = settings.analysis.hopSize;
 
@@ -249,72 +459,68 @@ vecVecReal featuresForSbic(const vecReal &waveform,
 
 	int const fftSize = frameSize * 2;
 
-
-	Algorithm* frameCutter = factory.create ("FrameCutter",
+	const auto frameCutter = std::unique_ptr<standard::Algorithm>(standardFactory::create ("FrameCutter",
 		"frameSize",               frameSize,
 		"hopSize",                 hopSize,
 		"lastFrameToEndOfFile",    true,
 		"silentFrames",            std::string ("keep"),
 		"startFromZero",           true,
 		"validFrameThresholdRatio", validFrameThresholdRatio
-	);
-
-	Algorithm* windowing = factory.create ("Windowing",
+	));
+	const auto windowing = std::unique_ptr<standard::Algorithm>(standardFactory::create ("Windowing",
 		"normalized", false,
 		"size",        frameSize,
 		"zeroPadding", zeroPadding,
 		"type",        settings.analysis.windowingType.toStdString(),
 		"zeroPhase",   false
-	);
-	Algorithm* spectrum = factory.create ("PowerSpectrum",
-		"size", fftSize
-	);
-	Algorithm* bfcc = factory.create ("BFCC",
-		"sampleRate",           sr,
-		"dctType",              settings.bfcc.dctType.toStdString(),
-		"highFrequencyBound",   settings.bfcc.highFrequencyBound,
-		"lowFrequencyBound",    settings.bfcc.lowFrequencyBound,
-		"inputSize",            frameSize + 1,
-		"liftering",            settings.bfcc.liftering,
-		"normalize",            settings.bfcc.normalize.toStdString(),
-		"numberBands",          settings.bfcc.numBands,
-		"numberCoefficients",   settings.bfcc.numCoefficients,
-		"weighting",            settings.bfcc.weightingType.toStdString(),
-		"type",                 settings.bfcc.spectrumType.toStdString(),
-		"logType",              "dbpow"	// log compr. type. Use ‘dbpow’ if working with power and ‘dbamp’ if working with magnitudes. DONT CHANGE unless also changing PowerSpectrum algo to Spectrum
-	);
-	Algorithm* barkFrameAccumulator = factory.create("VectorRealAccumulator");
-	Algorithm* bfccFrameAccumulator = factory.create("VectorRealAccumulator");
-
-	// for some reason, to get this working in as a connection to FrameAccumulator,
-	// these must be vector<vector<vector<Real>>>, and the 1st dimension only has size of 1...
-	std::vector<std::vector<vecReal>> barkBands, BFCCs;
-	VectorOutput<std::vector<vecReal>> *barkAccumOutput = new VectorOutput<std::vector<vecReal>>(&barkBands);
-	VectorOutput<std::vector<vecReal>> *bfccAccumOutput = new VectorOutput<std::vector<vecReal>>(&BFCCs);
-
-	*inVec								>>	frameCutter->input("signal");
-	frameCutter->output("frame")		>>	windowing->input("frame");
-	windowing->output("frame")			>>	spectrum->input("signal");
-	spectrum->output("powerSpectrum")	>>	bfcc->input("spectrum");
-	bfcc->output("bands")				>>	barkFrameAccumulator->input("data");
-	bfcc->output("bfcc")				>>	bfccFrameAccumulator->input("data");
-	barkFrameAccumulator->output("array") >> *barkAccumOutput;
-	bfccFrameAccumulator->output("array") >> *bfccAccumOutput;
-
-	Network n(inVec);
-	n.runPrepare();
-	while (n.runStep()){
-		if (shouldExit()){
-			break;
+	));
+
+	// the power spectrum goes into BFCC configured with the user's spectrumType, which decides whether the bands weigh
+	// it or its square, as in the PowerSpectrum -> BFCC chain this replaces; the log compression is always dbpow
+	SpectralFrontEnd frontEnd(fftSize, SpectralFrontEnd::Output::Power);
+	BatchBFCC bfcc(settings, "dbpow");
+
+	// BFCC and the spectra run a block of frames at a time
+	constexpr size_t blockFrames {64};
+	FeatureMatrix<Real> windowedFrames(static_cast<size_t>(fftSize)), spectra, BFCCs(static_cast<size_t>(bfcc.getNumCoefficients()));
+	windowedFrames.reserveRows(blockFrames);
+	BFCCs.reserveRows(blockFrames);
+
+	vecVecReal features;
+	vecReal frame, windowedFrame;
+	frameCutter->input("signal").set(waveform);
+	frameCutter->output("frame").set(frame);
+	windowing->input("frame").set(frame);
+	windowing->output("frame").set(windowedFrame);
+	while (true) {
+		frameCutter->compute();
+		const bool done = frame.empty();
+		if (!done) {
+			windowing->compute();
+			windowedFrames.appendRow(windowedFrame);
+		}
+		if (done || windowedFrames.numRows() == blockFrames) {
+			frontEnd.compute(windowedFrames, spectra);
+			BFCCs.clearRows();
+			for (size_t i = 0; i < spectra.numRows(); ++i) {
+				BFCCs.appendRow();
+			}
+			bfcc.compute(spectra, BFCCs);
+			for (size_t i = 0; i < BFCCs.numRows(); ++i) {
+				const auto row = BFCCs.rowSpan(i);
+				features.emplace_back(row.begin(), row.end());
+			}
+			windowedFrames.clearRows();
+			if (done || shouldExit()) {
+				break;
+			}
 		}
 	}
-	n.clear();
 
-	assert(BFCCs.size() == 1);
-	assert(BFCCs[0].size());
-	assert(BFCCs[0][0].size());
+	assert(features.size());
+	assert(features[0].size());
 
-	return BFCCs[0];	// the only dimension that was used
+	return features;
 }
 
 vecReal sBic(const array2dReal &featureMatrix, const standardFactory &factory,
@@ -337,6 +543,51 @@ vecReal sBic(const array2dReal &featureMatrix, const standardFactory &factory,
 	return segmentationVec;
 }
 
+std::vector<EventView> calculateEventViews(const size_t waveLength, const vecReal &onsetsInSeconds,
+										  const AnalyzerSettings &settings)
+{
+	size_t const numOnsets {onsetsInSeconds.size()};
+	assert(numOnsets);
+	if (numOnsets == 1){	// only 1 event
+		return { EventView{0, waveLength} };
+	}
+    const auto sampleRate = static_cast<double>(settings.analysis.sampleRate);
+	assert (sampleRate > 8000.0);
+
+	// like the Slicer in splitWaveIntoEvents, each event runs up to the next onset, and the last one up to the final sample
+	auto const toSample = [sampleRate, waveLength](const double seconds) {
+		return std::min(static_cast<size_t>(std::lround(seconds * sampleRate)), waveLength);
+	};
+	std::vector<EventView> views;
+	views.reserve(numOnsets);
+	for (size_t i = 0; i < numOnsets; ++i) {
+		const size_t start = toSample(onsetsInSeconds[i]);
+		const size_t end = (i + 1 < numOnsets) ? toSample(onsetsInSeconds[i + 1]) : (waveLength - 1);
+		assert (start <= end);
+		views.push_back({ start, end - start });
+	}
+	return views;
+}
+
+std::vector<EventChunk> chunkEventsBySampleCount(const std::span<EventView const> events, const size_t targetSamples)
+{
+	std::vector<EventChunk> chunks;
+	size_t begin {0};
+	size_t samples {0};
+	for (size_t i = 0; i < events.size(); ++i) {
+		samples += events[i].length;
+		if (samples >= targetSamples) {
+			chunks.push_back({ begin, i + 1 });
+			begin = i + 1;
+			samples = 0;
+		}
+	}
+	if (begin < events.size()) {
+		chunks.push_back({ begin, events.size() });
+	}
+	return chunks;
+}
+
 vecVecReal splitWaveIntoEvents(const vecReal&wave, const vecReal&onsetsInSeconds,
 							   const streamingFactory &factory,
 							   const AnalyzerSettings &settings,
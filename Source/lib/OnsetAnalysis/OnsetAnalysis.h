@@ -12,6 +12,8 @@
 #include "AnalysisUsing.h"
 #include "Settings.h"
 #include "../RunLoopStatus.h"
+#include "../AnalysisScheduler.h"
+#include <span>
 
 namespace nvs {
 namespace analysis {
@@ -24,14 +26,60 @@ inline array2dReal vecVecToArray2dReal(vecVecReal const &vv){
     return essentia::transpose(essentia::vecvecToArray2D(vv));
 }
 
+// how the onset detection functions frame the signal, given the file's sample rate and settings.onset.rateConversion
+struct OnsetFrameGeometry {
+	bool resample {false};		// resampled to 44.1 kHz first
+	int decimation {1};			// decimated by this factor first
+	Real sampleRate {44100.f};	// of the signal that is framed, after any resampling or decimation
+	int frameSize {1024};
+	int hopSize {512};
+
+	Real frameRate() const { return sampleRate / static_cast<Real>(hopSize); }
+};
+OnsetFrameGeometry getOnsetFrameGeometry(AnalyzerSettings const &settings);
+// lowpasses and keeps every factor-th sample, computing only the kept samples. output n is centered on input n * factor.
+vecReal decimate(std::span<Real const> signal, int factor);
+
+// rows are the hfc, complex, complex_phase, flux and rms detection functions. with settings.onset.fusedDetection they are
+// computed by OnsetDetectionKernel, otherwise by Essentia's OnsetDetection.
 array2dReal calculateOnsetsMatrix(vecReal const &waveform, streamingFactory const &factory, AnalyzerSettings const &settings,
 								  RunLoopStatus& rls, const ShouldExitFn &shouldExit);
+// same matrix as calculateOnsetsMatrix, with the detection functions computed in overlapping time chunks on the scheduler.
+// the file is resampled once up front; each chunk then starts a few frames early, so its kept frames are not
+// zero-padded and the detection functions that look back at previous frames have their history.
+// returns an empty matrix if stopped early.
+array2dReal calculateOnsetsMatrixInChunks(vecReal const &waveform, streamingFactory const &factory, AnalyzerSettings const &settings,
+										  AnalysisScheduler &scheduler, RunLoopStatus& rls, const ShouldExitFn &shouldExit);
+// identifies every setting calculateOnsetsMatrix's result depends on
+juce::String onsetDetectionKey(AnalyzerSettings const &settings);
 vecReal calculateOnsetsInSeconds(const array2dReal &onsetAnalysisMatrix, standardFactory const &factory, AnalyzerSettings const &settings);
 
 vecVecReal featuresForSbic(vecReal const &waveform, AlgorithmFactory const &factory,  AnalyzerSettings const &settings,
 						   RunLoopStatus& rls, const ShouldExitFn &shouldExit);
 vecReal sBic(const array2dReal &featureMatrix, standardFactory const &factory, AnalyzerSettings const &settings);
 
+// an event as an (offset, length) window into the analyzed wave. split fades are not applied; consumers apply them
+// lazily (see EventFramePipeline), so events never have to be copied out of the wave.
+struct EventView {
+	size_t offset {0};
+	size_t length {0};
+
+	std::span<Real const> of(vecReal const &wave) const {
+		return std::span<Real const>(wave).subspan(offset, length);
+	}
+};
+// same boundaries as splitWaveIntoEvents, without copying any audio
+std::vector<EventView> calculateEventViews(size_t waveLength, vecReal const &onsetsInSeconds, AnalyzerSettings const &settings);
+
+// a run of consecutive events [begin, end), analyzed as one scheduler task
+struct EventChunk {
+	size_t begin {0};
+	size_t end {0};
+};
+// groups consecutive events into chunks of at least targetSamples audio each (the last chunk may be shorter), so that
+// many short events (e.g. uniform segmentation) don't each become a task of their own
+std::vector<EventChunk> chunkEventsBySampleCount(std::span<EventView const> events, size_t targetSamples);
+
 vecVecReal splitWaveIntoEvents(vecReal const &wave, vecReal const &onsetsInSeconds, streamingFactory const &factory, AnalyzerSettings const &settings,
 							   RunLoopStatus& rls, const ShouldExitFn &shouldExit);
 
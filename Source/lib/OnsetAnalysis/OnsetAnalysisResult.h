@@ -8,13 +8,14 @@
 namespace nvs::analysis {
 
 struct OnsetAnalysisResult {
-    OnsetAnalysisResult(std::vector<float> onsets_, juce::String hash_, juce::String path_)
-    :   onsets(std::move(onsets_)), waveformHash(std::move(hash_)), audioFileAbsPath(std::move(path_)) {}
+    OnsetAnalysisResult(std::vector<float> onsets_, juce::String hash_, juce::String path_, size_t numSamples_)
+    :   onsets(std::move(onsets_)), waveformHash(std::move(hash_)), audioFileAbsPath(std::move(path_)), numSamples(numSamples_) {}
 
-    std::vector<float> onsets;
+    std::vector<float> onsets;      // normalized to the length of the wave, 0..1
 
     juce::String waveformHash {};
     juce::String audioFileAbsPath {};
+    size_t numSamples {0};          // the length the onsets are normalized to
 };
 
 } // namespace nvs::analysis
\ No newline at end of file
@@ -0,0 +1,192 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "OnsetDetectionKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace nvs::analysis {
+
+namespace {
+
+using FVO = juce::FloatVectorOperations;
+
+// independent partial sums, so the reduction vectorizes without reassociation flags
+Real sum(const vecReal &v) {
+    constexpr size_t lanes {8};
+    std::array<Real, lanes> partial {};
+    size_t i {0};
+    for (; i + lanes <= v.size(); i += lanes) {
+        for (size_t l = 0; l < lanes; ++l) {
+            partial[l] += v[i + l];
+        }
+    }
+    Real total {0.f};
+    for (; i < v.size(); ++i) {
+        total += v[i];
+    }
+    for (const auto p : partial) {
+        total += p;
+    }
+    return total;
+}
+
+}   // anonymous namespace
+
+OnsetDetectionKernel::OnsetDetectionKernel(const OnsetFrameGeometry &geometry)
+:   _frontEnd(2 * geometry.frameSize, SpectralFrontEnd::Output::Complex)  // the frame is zero-padded to twice its size
+,   _frameBlock(2 * static_cast<size_t>(geometry.frameSize))
+,   _spectrumBlock(_frontEnd.getNumColumns())
+,   _numBins(_frontEnd.getNumBins())
+{
+    const auto &factory = essentia::standard::AlgorithmFactory::instance();
+    _frameCutter = std::unique_ptr<StandardAlgorithm>(factory.create("FrameCutter",
+                                                                     "frameSize", geometry.frameSize,
+                                                                     "hopSize", geometry.hopSize,
+                                                                     "startFromZero", false,
+                                                                     "lastFrameToEndOfFile", true,
+                                                                     "validFrameThresholdRatio", 0.0f));
+    _windowing = std::unique_ptr<StandardAlgorithm>(factory.create("Windowing",
+                                                                   "normalized", true,
+                                                                   "size", geometry.frameSize,
+                                                                   "zeroPhase", false,
+                                                                   "zeroPadding", geometry.frameSize,
+                                                                   "type", "hamming"));
+
+    _frameCutter->output("frame").set(_frame);
+    _windowing->output("frame").set(_windowedFrame);
+    _spectrum.resize(_frontEnd.getNumColumns());
+    _frameBlock.reserveRows(blockFrames);
+    _spectrumBlock.reserveRows(blockFrames);
+
+    for (auto *v : {&_real, &_imag, &_power, &_magnitude, &_unitReal, &_unitImag, &_scratch,
+                    &_prevMagnitude, &_prevUnitReal, &_prevUnitImag, &_prevPrevUnitReal, &_prevPrevUnitImag}) {
+        v->resize(_numBins);
+    }
+    // hfc (Masri): bin power weighted by bin frequency
+    const Real hzPerBin = (geometry.sampleRate / 2.f) / static_cast<Real>(_numBins - 1);
+    _binFrequencies.resize(_numBins);
+    for (size_t k = 0; k < _numBins; ++k) {
+        _binFrequencies[k] = static_cast<Real>(k) * hzPerBin;
+    }
+    reset();
+}
+
+OnsetDetectionKernel::~OnsetDetectionKernel() = default;
+
+void OnsetDetectionKernel::reset() {
+    // silence: zero magnitude, phase 0
+    std::ranges::fill(_prevMagnitude, 0.f);
+    std::ranges::fill(_prevUnitReal, 1.f);
+    std::ranges::fill(_prevUnitImag, 0.f);
+    std::ranges::fill(_prevPrevUnitReal, 1.f);
+    std::ranges::fill(_prevPrevUnitImag, 0.f);
+    _prevRms = 0.f;
+}
+
+bool OnsetDetectionKernel::process(const vecReal &signal, DetectionFunctions &detections, const ShouldExitFn &shouldExit) {
+    reset();
+    _frameCutter->input("signal").set(signal);
+    _frameCutter->reset();
+
+    _frameBlock.clearRows();
+
+    // frames are windowed as they are cut and transformed a block at a time; shouldExit is checked once per block
+    while (true) {
+        _frameCutter->compute();
+        const bool done = _frame.empty();
+        if (!done) {
+            _windowing->input("frame").set(_frame);
+            _windowing->compute();
+            _frameBlock.appendRow(_windowedFrame);
+        }
+        if (done || _frameBlock.numRows() == blockFrames) {
+            _frontEnd.compute(_frameBlock, _spectrumBlock);
+            for (size_t f = 0; f < _spectrumBlock.numRows(); ++f) {
+                const auto values = detect(_spectrumBlock.rowSpan(f));
+                for (size_t i = 0; i < numDetectionFunctions; ++i) {
+                    detections[i].push_back(values[i]);
+                }
+            }
+            _frameBlock.clearRows();
+            if (done) {
+                return true;
+            }
+            if (shouldExit()) {
+                return false;
+            }
+        }
+    }
+}
+
+auto OnsetDetectionKernel::processFrame(const vecReal &frame) -> std::array<Real, numDetectionFunctions> {
+    _windowing->input("frame").set(frame);
+    _windowing->compute();
+    _frontEnd.compute(_windowedFrame, _spectrum);
+    return detect(_spectrum);
+}
+
+auto OnsetDetectionKernel::detect(const std::span<const Real> spectrum) -> std::array<Real, numDetectionFunctions> {
+    const auto n = static_cast<int>(_numBins);
+    jassert (spectrum.size() == 2 * _numBins);
+    for (size_t k = 0; k < _numBins; ++k) {
+        _real[k] = spectrum[2 * k];
+        _imag[k] = spectrum[2 * k + 1];
+    }
+    FVO::multiply(_power.data(), _real.data(), _real.data(), n);
+    FVO::addWithMultiply(_power.data(), _imag.data(), _imag.data(), n);
+    for (size_t k = 0; k < _numBins; ++k) {
+        _magnitude[k] = std::sqrt(_power[k]);
+    }
+
+    FVO::multiply(_scratch.data(), _power.data(), _binFrequencies.data(), n);
+    const Real hfc = sum(_scratch);
+
+    // half-rectified change in the RMS of the magnitude spectrum
+    const Real rms = std::sqrt(sum(_power) / static_cast<Real>(_numBins));
+    const Real rmsChange = std::max(0.f, rms - _prevRms);
+    _prevRms = rms;
+
+    // spectral flux: L1 norm of the half-rectified magnitude increase
+    FVO::subtract(_scratch.data(), _magnitude.data(), _prevMagnitude.data(), n);
+    FVO::max(_scratch.data(), _scratch.data(), 0.f, n);
+    const Real flux = sum(_scratch);
+
+    // unit phasors; a silent bin has phase 0, as atan2(0, 0) gives
+    for (size_t k = 0; k < _numBins; ++k) {
+        const Real m = _magnitude[k];
+        const Real inverse = m > 0.f ? 1.f / m : 0.f;
+        _unitReal[k] = m > 0.f ? _real[k] * inverse : 1.f;
+        _unitImag[k] = _imag[k] * inverse;
+    }
+
+    // the phase is predicted to keep advancing as it did over the last two frames: target = u1^2 * conj(u2).
+    // deviation = u * conj(target) has the angle (phase - targetPhase), already wrapped to (-pi, pi].
+    Real complexDomain {0.f}, complexPhase {0.f};
+    for (size_t k = 0; k < _numBins; ++k) {
+        const Real u1r = _prevUnitReal[k], u1i = _prevUnitImag[k];
+        const Real u2r = _prevPrevUnitReal[k], u2i = _prevPrevUnitImag[k];
+        const Real squaredReal = u1r * u1r - u1i * u1i, squaredImag = 2.f * u1r * u1i;
+        const Real targetReal = squaredReal * u2r + squaredImag * u2i;
+        const Real targetImag = squaredImag * u2r - squaredReal * u2i;
+        const Real deviationReal = _unitReal[k] * targetReal + _unitImag[k] * targetImag;
+        const Real deviationImag = _unitImag[k] * targetReal - _unitReal[k] * targetImag;
+
+        // distance from the predicted bin (previous magnitude at the target phase), by the law of cosines
+        const Real m = _magnitude[k], prevM = _prevMagnitude[k];
+        complexDomain += std::sqrt(std::max(0.f, m * m + prevM * prevM - 2.f * m * prevM * deviationReal));
+        complexPhase += m * std::abs(std::atan2(deviationImag, deviationReal));
+    }
+
+    std::swap(_prevPrevUnitReal, _prevUnitReal);
+    std::swap(_prevPrevUnitImag, _prevUnitImag);
+    std::swap(_prevUnitReal, _unitReal);
+    std::swap(_prevUnitImag, _unitImag);
+    std::swap(_prevMagnitude, _magnitude);
+
+    return { hfc, complexDomain, complexPhase, flux, rmsChange };
+}
+
+}   // namespace nvs::analysis
@@ -0,0 +1,65 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <array>
+#include <memory>
+#include <span>
+
+#include "OnsetAnalysis.h"
+#include "../FeatureMatrix.h"
+#include "../SpectralFrontEnd.h"
+
+namespace nvs::analysis {
+
+/**
+ * Computes all five onset detection functions (hfc, complex, complex_phase, flux, rms, in that order) in one pass
+ * over each frame's spectrum, in place of CartesianToPolar and five OnsetDetection instances that each convert to
+ * polar form and keep their own history. The previous frame's magnitudes and unit phasors are kept once and shared.
+ * Framing and windowing are Essentia's, configured as in calculateOnsetsMatrix, so the frames are the same; the spectra
+ * of blockFrames frames at a time come from a SpectralFrontEnd, in place of Essentia's FFT.
+ *
+ * Phase differences are taken as products of unit phasors rather than differences of angles, so the only
+ * transcendental per bin is the one atan2 complex_phase needs; everything else is elementwise over contiguous arrays.
+ */
+class OnsetDetectionKernel {
+public:
+    static constexpr size_t numDetectionFunctions {5};
+    using DetectionFunctions = std::array<vecReal, numDetectionFunctions>;
+
+    explicit OnsetDetectionKernel(const OnsetFrameGeometry &geometry);
+    ~OnsetDetectionKernel();
+
+    // appends one value per frame of signal to each detection function. the history starts from silence, as a fresh
+    // OnsetDetection's does. returns false if stopped early.
+    bool process(const vecReal &signal, DetectionFunctions &detections, const ShouldExitFn &shouldExit);
+
+    // one frame of frameSize samples, cut by the caller (e.g. from a live stream): windows it, takes its spectrum and
+    // returns the five values. the history carries over from the previous frame.
+    std::array<Real, numDetectionFunctions> processFrame(const vecReal &frame);
+    // restarts the history from silence
+    void reset();
+
+private:
+    using StandardAlgorithm = essentia::standard::Algorithm;
+    std::unique_ptr<StandardAlgorithm> _frameCutter, _windowing;
+    SpectralFrontEnd _frontEnd;
+    vecReal _frame, _windowedFrame, _spectrum;
+    // windowed frames waiting for their spectra, and the spectra (interleaved complex) of a block
+    static constexpr size_t blockFrames {64};
+    FeatureMatrix<Real> _frameBlock, _spectrumBlock;
+
+    const size_t _numBins;
+    vecReal _binFrequencies;    // Hz, for hfc
+    // this frame
+    vecReal _real, _imag, _power, _magnitude, _unitReal, _unitImag, _scratch;
+    // history shared by all five functions
+    vecReal _prevMagnitude, _prevUnitReal, _prevUnitImag, _prevPrevUnitReal, _prevPrevUnitImag;
+    Real _prevRms {0.f};
+
+    // spectrum: interleaved (real, imaginary) per bin
+    std::array<Real, numDetectionFunctions> detect(std::span<const Real> spectrum);
+};
+
+}   // namespace nvs::analysis
@@ -9,6 +9,7 @@
 */
 
 #include "Settings.h"
+#include <set>
 #include "Analyzer.h"
 #include "StringAxiom.h"
 
@@ -52,7 +53,8 @@ const std::map<juce::String, AnySpec> bfccSpecs
 	{ axiom::tsn::numBands,            RangedSettingsSpec<int>{
 	    {1,128,1,1},40,
 	    "the number of bark bands in the filter" } },
-	{ axiom::tsn::numCoefficients,     RangedSettingsSpec<int>{   {5,26,1,1}, 13 } },
+	{ axiom::tsn::numCoefficients,     RangedSettingsSpec<int>{   {5,26,1,1}, 13,
+	    "the number of coefficients Essentia's BFCC computes; the timbre features keep the first 13" } },
 	{ axiom::tsn::normalize,           ChoiceSettingsSpec{
 	    {axiom::tsn::unit_sum, axiom::tsn::unit_max},axiom::tsn::unit_sum,
 	    "'unit_max' makes the vertex of all the triangles equal to 1, 'unit_sum' makes the area of all the triangles equal to 1." } },
@@ -71,6 +73,10 @@ const std::map<juce::String, AnySpec> onsetSpecs
 {
     { axiom::tsn::segmentation, ChoiceSettingsSpec {{axiom::tsn::Event, axiom::tsn::Uniform}, axiom::tsn::Event,
         "whether to segment by detected events or uniform frames"} },
+    { axiom::tsn::rateConversion, ChoiceSettingsSpec {{axiom::tsn::Resample, axiom::tsn::Native, axiom::tsn::Decimate}, axiom::tsn::Resample,
+        "how onset detection handles the file's sample rate: resample to 44.1 kHz, analyze at the native rate with a scaled hop, or decimate high-rate files first"} },
+    { axiom::tsn::fusedDetection, BoolSettingsSpec {false,
+        "compute all five detection functions in one pass over each spectrum, instead of with five separate OnsetDetection algorithms"} },
 	{ axiom::tsn::silenceThreshold,         RangedSettingsSpec<double>{ {0.0,1.0,0.01f,0.4}, 0.1f,
 	    "the threshold for silence"} },
 	{ axiom::tsn::alpha,                    RangedSettingsSpec<double>{ {0.0,1.0,0.01f,0.4}, 0.1f,
@@ -101,7 +107,8 @@ const std::map<juce::String, AnySpec> sBicSpecs
 
 const std::map<juce::String, AnySpec> pitchSpecs
 {
-	{ axiom::tsn::pitchDetectionAlgorithm,  ChoiceSettingsSpec{ {axiom::tsn::yin,axiom::tsn::pYin,axiom::tsn::chroma}, axiom::tsn::yin } },
+	{ axiom::tsn::pitchDetectionAlgorithm,  ChoiceSettingsSpec{ {axiom::tsn::yin,axiom::tsn::yinFast,axiom::tsn::pYin,axiom::tsn::chroma}, axiom::tsn::yin,
+	    "yinFast computes the same YIN difference function from an FFT autocorrelation, much faster at large frame sizes; pYin smooths it over each event; chroma follows the dominant pitch class" } },
 	{ axiom::tsn::interpolate,              BoolSettingsSpec{ true } },
 	{ axiom::tsn::maxFrequency,             RangedSettingsSpec<double>{ {20.0,22050.0, 1.0, 1.0}, 4000.0 } },
 	{ axiom::tsn::minFrequency,             RangedSettingsSpec<double>{ {20.0,22050.0, 1.0, 1.0},  140.0 } },
@@ -174,6 +181,10 @@ void initializeSettingsBranches(ValueTree& settingsVT, const bool dbg){
 	}
 }
 
+// properties added after settings files were already being saved: the strict check doesn't require them, and
+// updateSettingsFromValueTree falls back to their defaults
+static const std::set<juce::String> optionalProperties { axiom::tsn::rateConversion, axiom::tsn::fusedDetection };
+
 bool verifySettingsStructure (const ValueTree& settingsVT)
 {
 	if (! settingsVT.isValid()){
@@ -191,7 +202,7 @@ bool verifySettingsStructure (const ValueTree& settingsVT)
 		// check every parameter key inside that branch
 		for (auto const& [propertyName, spec] : *specMapPtr) {
             if (juce::Identifier propertyId (propertyName);
-                !branchVT.hasProperty(propertyId))
+                !branchVT.hasProperty(propertyId) && !optionalProperties.contains(propertyName))
             {
 				return false;
 			}
@@ -245,6 +256,63 @@ bool verifySettingsStructureWithAttemptedFix (ValueTree& settingsVT)
     return true;
 }
 
+static juce::String rateConversionToString(const AnalyzerSettings::Onset::RateConversion rateConversion) {
+    switch (rateConversion) {
+        case AnalyzerSettings::Onset::RateConversion::Native:   return axiom::tsn::Native;
+        case AnalyzerSettings::Onset::RateConversion::Decimate: return axiom::tsn::Decimate;
+        default:                                                return axiom::tsn::Resample;
+    }
+}
+static AnalyzerSettings::Onset::RateConversion rateConversionFromString(const juce::String &rateConversion) {
+    if (rateConversion == axiom::tsn::Native) {
+        return AnalyzerSettings::Onset::RateConversion::Native;
+    }
+    if (rateConversion == axiom::tsn::Decimate) {
+        return AnalyzerSettings::Onset::RateConversion::Decimate;
+    }
+    return AnalyzerSettings::Onset::RateConversion::Resample;
+}
+
+// requested features and statistics are stored by name
+static juce::String getRequestName(const Feature_e f) {
+    if (isBFCC(f)) {
+        return "bfcc" + juce::String(static_cast<int>(f));
+    }
+    static constexpr std::array<const char *, static_cast<size_t>(Feature_e::NumFeatures) - NumBFCC> names {
+        axiom::tsn::SpectralCentroid, axiom::tsn::SpectralDecrease, axiom::tsn::SpectralFlatness, axiom::tsn::SpectralCrest,
+        axiom::tsn::SpectralComplexity, axiom::tsn::StrongPeak, axiom::tsn::Periodicity, axiom::tsn::Loudness, axiom::tsn::f0
+    };
+    return names[static_cast<size_t>(f) - NumBFCC];
+}
+static juce::String getRequestName(const Statistic s) {
+    static constexpr std::array<const char *, static_cast<size_t>(Statistic::NumStatistics)> names {
+        axiom::tsn::mean, axiom::tsn::median, axiom::tsn::variance, axiom::tsn::skewness, axiom::tsn::kurtosis
+    };
+    return names[static_cast<size_t>(s)];
+}
+template <typename Enum, size_t N>
+static juce::String requestToString(const std::bitset<N> &requested) {
+    juce::StringArray names;
+    for (size_t i = 0; i < N; ++i) {
+        if (requested.test(i)) {
+            names.add(getRequestName(static_cast<Enum>(i)));
+        }
+    }
+    return names.joinIntoString(",");
+}
+template <typename Enum, size_t N>
+static std::bitset<N> requestFromString(const juce::String &str) {
+    const auto names = juce::StringArray::fromTokens(str, ",", "");
+    std::bitset<N> requested;
+    for (size_t i = 0; i < N; ++i) {
+        requested.set(i, names.contains(getRequestName(static_cast<Enum>(i))));
+    }
+    if (static_cast<size_t>(names.size()) != requested.count()) {
+        std::cerr << "ignoring unknown names in requested " << str << "\n";
+    }
+    return requested;
+}
+
 juce::ValueTree createParentTreeFromSettings(const AnalyzerSettings& settings) {
     juce::ValueTree parent("Root");
 
@@ -263,6 +331,13 @@ juce::ValueTree createParentTreeFromSettings(const AnalyzerSettings& settings) {
     analysisNode.setProperty(axiom::tsn::hopSize, settings.analysis.hopSize, nullptr);
     analysisNode.setProperty(axiom::tsn::windowingType, settings.analysis.windowingType, nullptr);
     analysisNode.setProperty(axiom::tsn::numThreads, settings.analysis.numThreads, nullptr);
+    // only stored when something is left out, so that the settings of full analyses (and their hashes) are unchanged
+    if (!settings.request.isEverything()) {
+        analysisNode.setProperty(axiom::tsn::requestedFeatures,
+                                 requestToString<Feature_e>(settings.request.features), nullptr);
+        analysisNode.setProperty(axiom::tsn::requestedStatistics,
+                                 requestToString<Statistic>(settings.request.statistics), nullptr);
+    }
     settingsTree.appendChild(analysisNode, nullptr);
 
     // BFCC node
@@ -284,6 +359,8 @@ juce::ValueTree createParentTreeFromSettings(const AnalyzerSettings& settings) {
     juce::ValueTree onsetNode(axiom::tsn::Onset);
     onsetNode.setProperty(axiom::tsn::segmentation,
         settings.onset.segmentation == AnalyzerSettings::Onset::Segmentation::Uniform ? axiom::tsn::Uniform : "Event", nullptr);
+    onsetNode.setProperty(axiom::tsn::rateConversion, rateConversionToString(settings.onset.rateConversion), nullptr);
+    onsetNode.setProperty(axiom::tsn::fusedDetection, settings.onset.fusedDetection, nullptr);
     onsetNode.setProperty(axiom::tsn::alpha, settings.onset.alpha, nullptr);
     onsetNode.setProperty(axiom::tsn::numFrames_shortOnsetFilter, settings.onset.numFrames_shortOnsetFilter, nullptr);
     onsetNode.setProperty(axiom::tsn::silenceThreshold, settings.onset.silenceThreshold, nullptr);
@@ -361,6 +438,16 @@ bool updateSettingsFromValueTree(AnalyzerSettings& settings, const ValueTree& se
     settings.analysis.hopSize = analysisNode.getProperty(axiom::tsn::hopSize);
     settings.analysis.windowingType = analysisNode.getProperty(axiom::tsn::windowingType).toString();
     settings.analysis.numThreads = analysisNode.getProperty(axiom::tsn::numThreads);
+    // absent when everything is requested
+    settings.request = {};
+    if (analysisNode.hasProperty(axiom::tsn::requestedFeatures)) {
+        settings.request.features = requestFromString<Feature_e, static_cast<size_t>(Feature_e::NumFeatures)>(
+            analysisNode.getProperty(axiom::tsn::requestedFeatures).toString());
+    }
+    if (analysisNode.hasProperty(axiom::tsn::requestedStatistics)) {
+        settings.request.statistics = requestFromString<Statistic, static_cast<size_t>(Statistic::NumStatistics)>(
+            analysisNode.getProperty(axiom::tsn::requestedStatistics).toString());
+    }
 
     // BFCC settings
     auto bfccNode = settingsTree.getChildWithName(axiom::tsn::BFCC);
@@ -415,6 +502,9 @@ bool updateSettingsFromValueTree(AnalyzerSettings& settings, const ValueTree& se
         settings.onset.segmentation = AnalyzerSettings::Onset::Segmentation::Event;
         DBG(juce::String("No property ") + axiom::tsn::segmentation + " found in settingsTree\n");
     }
+    // older settings files predate rateConversion (they were analyzed at 44.1 kHz) and fusedDetection
+    settings.onset.rateConversion = rateConversionFromString(onsetNode.getProperty(axiom::tsn::rateConversion, axiom::tsn::Resample).toString());
+    settings.onset.fusedDetection = onsetNode.getProperty(axiom::tsn::fusedDetection, false);
 	settings.onset.alpha = onsetNode.getProperty(axiom::tsn::alpha);
 	settings.onset.numFrames_shortOnsetFilter = onsetNode.getProperty(axiom::tsn::numFrames_shortOnsetFilter);
 	settings.onset.silenceThreshold = onsetNode.getProperty(axiom::tsn::silenceThreshold);
@@ -443,6 +533,12 @@ bool updateSettingsFromValueTree(AnalyzerSettings& settings, const ValueTree& se
 	settings.pitch.minFrequency = pitchNode.getProperty(axiom::tsn::minFrequency);
 	settings.pitch.pitchDetectionAlgorithm = pitchNode.getProperty(axiom::tsn::pitchDetectionAlgorithm).toString();
 	settings.pitch.tolerance = pitchNode.getProperty(axiom::tsn::tolerance);
+	if (settings.pitch.minFrequency >= settings.pitch.maxFrequency) {
+		std::cerr << "Pitch minFrequency (" << settings.pitch.minFrequency << " Hz) must be below maxFrequency ("
+				  << settings.pitch.maxFrequency << " Hz)\n";
+		jassertfalse;
+		return false;
+	}
 
     // Loudness settings
     auto loudnessNode = settingsTree.getChildWithName(axiom::tsn::Loudness);
@@ -9,8 +9,11 @@
 */
 
 #pragma once
+#include <bitset>
 #include "essentia/types.h"
 #include <juce_data_structures/juce_data_structures.h>
+#include "Features.h"
+#include "Statistics.h"
 
 namespace nvs::analysis {
 
@@ -62,6 +65,20 @@ struct AnalyzerSettings {
         int numThreads = 2;
     } analysis;
 
+    // the features and statistics the analysis is asked for. only the algorithms these need are run; every other
+    // statistic is left at zero. everything, by default
+    struct Request {
+        std::bitset<static_cast<size_t>(Feature_e::NumFeatures)> features {~0ull};
+        std::bitset<static_cast<size_t>(Statistic::NumStatistics)> statistics {~0ull};
+
+        bool wants(const Feature_e f) const { return features.test(static_cast<size_t>(f)); }
+        bool wants(const Statistic s) const { return statistics.test(static_cast<size_t>(s)); }
+        bool wantsAnyBFCC() const {
+            return std::any_of(bfccSet.begin(), bfccSet.end(), [this](const Feature_e f) { return wants(f); });
+        }
+        bool isEverything() const { return features.all() && statistics.all(); }
+    } request;
+
     struct BFCC {
         juce::String dctType = "typeII";
         double highFrequencyBound = 4000.0;
@@ -86,6 +103,14 @@ struct AnalyzerSettings {
             Uniform // use uniformly distributed segments, specified by analysis.hopSize and analysis.frameSize
         } segmentation {Segmentation::Uniform};
 
+        // how the signal reaches the onset detection functions' frame rate
+        enum class RateConversion {
+            Resample,   // resample to 44.1 kHz (skipped if the file is already at 44.1 kHz), hop 512
+            Native,     // analyze at the file's rate, with hop and frame scaled by the nearest power of two
+            Decimate    // like Native, after decimating high-rate (>= 88.2 kHz) input by an integer factor
+        } rateConversion {RateConversion::Resample};
+        bool fusedDetection = false;    // compute the detection functions with OnsetDetectionKernel instead of OnsetDetection
+
         double alpha = 0.1;
         int numFrames_shortOnsetFilter = 5;
         double silenceThreshold = 0.1;
@@ -100,7 +125,7 @@ struct AnalyzerSettings {
         bool interpolate = true;
         double maxFrequency = 3000.0;
         double minFrequency = 100.0;
-        juce::String pitchDetectionAlgorithm = "yin";
+        juce::String pitchDetectionAlgorithm = "yin";    // or "yinFast", "pYin", "chroma"
         double tolerance = 0.15;
     } pitch;
 
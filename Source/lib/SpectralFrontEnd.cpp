@@ -0,0 +1,95 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "SpectralFrontEnd.h"
+#include <map>
+#include <juce_dsp/juce_dsp.h>
+
+namespace nvs::analysis {
+
+namespace {
+int getOrder(const int fftSize) {
+    return juce::isPowerOfTwo(fftSize) ? juce::roundToInt(std::log2(fftSize)) : -1;
+}
+}   // anonymous namespace
+
+SpectralFrontEnd::SpectralFrontEnd(const int fftSize, const Output output)
+:   _fftSize(fftSize)
+,   _output(output)
+,   _numBins(static_cast<size_t>(fftSize / 2 + 1))
+,   _order(getOrder(fftSize))
+{
+    jassert (fftSize > 1 && fftSize % 2 == 0);
+    if (_order >= 0) {
+        _buffer.resize(2 * static_cast<size_t>(fftSize));
+    } else {
+        _essentiaFFT = std::unique_ptr<standard::Algorithm>(standardFactory::create("FFT",
+            "size", fftSize));
+        _essentiaFrame.resize(static_cast<size_t>(fftSize));
+        _essentiaFFT->input("frame").set(_essentiaFrame);
+        _essentiaFFT->output("fft").set(_essentiaSpectrum);
+    }
+}
+
+SpectralFrontEnd::~SpectralFrontEnd() = default;
+
+juce::dsp::FFT &SpectralFrontEnd::getPlan(const int order) {
+    thread_local std::map<int, std::unique_ptr<juce::dsp::FFT>> plans;
+    auto &plan = plans[order];
+    if (plan == nullptr) {
+        plan = std::make_unique<juce::dsp::FFT>(order);
+    }
+    return *plan;
+}
+
+void SpectralFrontEnd::compute(FeatureMatrix<Real> const &frames, FeatureMatrix<Real> &spectra)
+{
+    if (spectra.numColumns() != getNumColumns()) {
+        spectra = FeatureMatrix<Real>(getNumColumns());
+    }
+    spectra.clearRows();
+    spectra.reserveRows(frames.numRows());
+    for (size_t i = 0; i < frames.numRows(); ++i) {
+        compute(frames.rowSpan(i), spectra.appendRow());
+    }
+}
+
+void SpectralFrontEnd::compute(const std::span<const Real> frame, const std::span<Real> spectrum)
+{
+    jassert (frame.size() <= static_cast<size_t>(_fftSize));
+    jassert (spectrum.size() == getNumColumns());
+
+    // interleaved (real, imaginary) of the non-negative frequencies
+    const Real *bins {nullptr};
+    if (_order >= 0) {
+        std::copy(frame.begin(), frame.end(), _buffer.begin());
+        std::fill(_buffer.begin() + static_cast<std::ptrdiff_t>(frame.size()), _buffer.end(), 0.f);
+        getPlan(_order).performRealOnlyForwardTransform(_buffer.data(), true);
+        bins = _buffer.data();
+    } else {
+        std::copy(frame.begin(), frame.end(), _essentiaFrame.begin());
+        std::fill(_essentiaFrame.begin() + static_cast<std::ptrdiff_t>(frame.size()), _essentiaFrame.end(), 0.f);
+        _essentiaFFT->compute();
+        jassert (_essentiaSpectrum.size() == _numBins);
+        bins = reinterpret_cast<const Real *>(_essentiaSpectrum.data());
+    }
+
+    switch (_output) {
+        case Output::Complex:
+            std::copy_n(bins, 2 * _numBins, spectrum.begin());
+            break;
+        case Output::Power:
+            for (size_t k = 0; k < _numBins; ++k) {
+                spectrum[k] = bins[2 * k] * bins[2 * k] + bins[2 * k + 1] * bins[2 * k + 1];
+            }
+            break;
+        case Output::Magnitude:
+            for (size_t k = 0; k < _numBins; ++k) {
+                spectrum[k] = std::sqrt(bins[2 * k] * bins[2 * k] + bins[2 * k + 1] * bins[2 * k + 1]);
+            }
+            break;
+    }
+}
+
+} // namespace nvs::analysis
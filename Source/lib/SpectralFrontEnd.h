@@ -0,0 +1,60 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <span>
+
+#include "AnalysisUsing.h"
+#include "FeatureMatrix.h"
+
+namespace juce::dsp { class FFT; }
+
+namespace nvs::analysis {
+
+/**
+ * Spectra of a block of windowed frames, in place of a Spectrum/PowerSpectrum/FFT instance per stage that plans its
+ * own transform and hands back a freshly allocated vector per frame.
+ * Transforms run on juce::dsp::FFT plans that are made once per size and thread and then shared by every front end on
+ * that thread; a block's spectra are written into one contiguous, preallocated row-major matrix that BFCC and the
+ * spectral descriptors read in place. Sizes that aren't a power of two fall back to Essentia's FFT.
+ * Like Essentia's, the transform is unnormalized, so magnitudes and powers match Spectrum and PowerSpectrum.
+ */
+class SpectralFrontEnd {
+public:
+    enum class Output {
+        Magnitude,  // |X|, as Spectrum
+        Power,      // |X|², as PowerSpectrum
+        Complex     // X, interleaved (real, imaginary) per bin, as FFT
+    };
+
+    // fftSize: the length frames are zero-padded to; spectra have fftSize / 2 + 1 bins
+    SpectralFrontEnd(int fftSize, Output output);
+    ~SpectralFrontEnd();
+
+    // the bins per spectrum, and the columns per output row (twice the bins for Output::Complex)
+    size_t getNumBins() const { return _numBins; }
+    size_t getNumColumns() const { return _output == Output::Complex ? 2 * _numBins : _numBins; }
+
+    // frames: one windowed frame per row, of at most fftSize samples. spectra is refilled with one row per frame,
+    // keeping its memory from block to block
+    void compute(FeatureMatrix<Real> const &frames, FeatureMatrix<Real> &spectra);
+    // one frame, into a row of getNumColumns() values
+    void compute(std::span<const Real> frame, std::span<Real> spectrum);
+
+private:
+    const int _fftSize;
+    const Output _output;
+    const size_t _numBins;
+    const int _order;   // log2 of fftSize, or -1 where it isn't a power of two
+
+    vecReal _buffer;    // 2 * fftSize, as juce::dsp::FFT's real transform works in place
+    // the fallback
+    std::unique_ptr<standard::Algorithm> _essentiaFFT;
+    vecReal _essentiaFrame;
+    std::vector<std::complex<Real>> _essentiaSpectrum;
+
+    static juce::dsp::FFT &getPlan(int order);
+};
+
+} // namespace nvs::analysis
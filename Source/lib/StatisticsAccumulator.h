@@ -0,0 +1,191 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <array>
+#include <span>
+#include <algorithm>
+#include <cmath>
+
+#include <juce_core/juce_core.h>
+#include "AnalysisUsing.h"
+#include "Features.h"
+#include "Statistics.h"
+
+namespace nvs::analysis {
+
+/**
+ * Streaming median estimate using the P² algorithm (Jain & Chlamtac, 1985): five markers, constant memory, one pass.
+ * Exact for up to 5 values (which covers most short uniform segments); an estimate beyond that.
+ */
+class P2Median {
+public:
+    void reset() { _count = 0; }
+
+    void push(const double x) {
+        if (_count < 5) {
+            _q[_count++] = x;
+            std::sort(_q.begin(), _q.begin() + _count);
+            if (_count == 5) {
+                _n = {1, 2, 3, 4, 5};
+                _np = {1.0, 2.0, 3.0, 4.0, 5.0};
+            }
+            return;
+        }
+        ++_count;
+
+        int k;
+        if (x < _q[0]) {
+            _q[0] = x;
+            k = 0;
+        } else if (x >= _q[4]) {
+            _q[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (x >= _q[k + 1]) {
+                ++k;
+            }
+        }
+        for (int i = k + 1; i < 5; ++i) {
+            ++_n[i];
+        }
+        for (int i = 0; i < 5; ++i) {
+            _np[i] += increments[i];
+        }
+
+        // adjust the middle markers toward their desired positions
+        for (int i = 1; i < 4; ++i) {
+            const double d = _np[i] - _n[i];
+            if ((d >= 1.0 && _n[i + 1] - _n[i] > 1) || (d <= -1.0 && _n[i - 1] - _n[i] < -1)) {
+                const int dSign = d > 0.0 ? 1 : -1;
+                if (const double qParabolic = parabolic(i, dSign);
+                    _q[i - 1] < qParabolic && qParabolic < _q[i + 1])
+                {
+                    _q[i] = qParabolic;
+                } else {
+                    _q[i] = _q[i] + dSign * (_q[i + dSign] - _q[i]) / (_n[i + dSign] - _n[i]);
+                }
+                _n[i] += dSign;
+            }
+        }
+    }
+
+    double get() const {
+        if (_count == 0) {
+            return 0.0;
+        }
+        if (_count <= 5) {  // markers still hold every value, sorted
+            return (_count % 2 == 1) ? _q[_count / 2] : 0.5 * (_q[_count / 2 - 1] + _q[_count / 2]);
+        }
+        return _q[2];
+    }
+
+private:
+    static constexpr std::array<double, 5> increments {0.0, 0.25, 0.5, 0.75, 1.0};
+
+    std::array<double, 5> _q {};    // marker heights
+    std::array<int, 5> _n {};       // marker positions
+    std::array<double, 5> _np {};   // desired marker positions
+    int _count {0};
+
+    double parabolic(const int i, const int d) const {
+        return _q[i] + d / static_cast<double>(_n[i + 1] - _n[i - 1])
+            * ((_n[i] - _n[i - 1] + d) * (_q[i + 1] - _q[i]) / (_n[i + 1] - _n[i])
+             + (_n[i + 1] - _n[i] - d) * (_q[i] - _q[i - 1]) / (_n[i] - _n[i - 1]));
+    }
+};
+
+/**
+ * Accumulates EventwiseStatistics for every Feature_e as frames are produced, without storing framewise values.
+ * Mean, variance, skewness and kurtosis come from one Welford/Pébay pass (same population conventions as
+ * essentia::variance/skewness/kurtosis), the median from a P2Median estimate.
+ * Moments are kept structure-of-arrays so that pushing a contiguous run of features is a vectorizable loop.
+ */
+class EventwiseStatisticsAccumulator {
+public:
+    static constexpr size_t NumSlots = static_cast<size_t>(Feature_e::NumFeatures);
+
+    // without estimateMedian, the median is left at zero and its per-value marker updates are skipped
+    explicit EventwiseStatisticsAccumulator(const bool estimateMedian = true) : _estimateMedian(estimateMedian) {}
+
+    void reset() {
+        _n.fill(0.0);
+        _mean.fill(0.0);
+        _m2.fill(0.0);
+        _m3.fill(0.0);
+        _m4.fill(0.0);
+        _weightedSum.fill(0.0);
+        _weightSum.fill(0.0);
+        for (auto &m : _medians) {
+            m.reset();
+        }
+    }
+
+    // adds one frame's values for the contiguous features [first, first + values.size()), all with the same weight.
+    // the weight only affects the (optionally) weighted mean.
+    void push(const Feature_e first, std::span<const Real> values, const Real weight = 1.f) {
+        const auto offset = static_cast<size_t>(first);
+        jassert (offset + values.size() <= NumSlots);
+
+        for (size_t j = 0; j < values.size(); ++j) {
+            const size_t i = offset + j;
+            const double x = values[j];
+            const double n1 = _n[i];
+            const double n = n1 + 1.0;
+            const double delta = x - _mean[i];
+            const double deltaN = delta / n;
+            const double deltaN2 = deltaN * deltaN;
+            const double term1 = delta * deltaN * n1;
+
+            _mean[i] += deltaN;
+            _m4[i] += term1 * deltaN2 * (n * n - 3.0 * n + 3.0) + 6.0 * deltaN2 * _m2[i] - 4.0 * deltaN * _m3[i];
+            _m3[i] += term1 * deltaN * (n - 2.0) - 3.0 * deltaN * _m2[i];
+            _m2[i] += term1;
+            _n[i] = n;
+
+            _weightedSum[i] += x * weight;
+            _weightSum[i] += weight;
+        }
+        if (_estimateMedian) {
+            for (size_t j = 0; j < values.size(); ++j) {
+                _medians[offset + j].push(values[j]);
+            }
+        }
+    }
+    void push(const Feature_e f, const Real value, const Real weight = 1.f) {
+        push(f, std::span<const Real>(&value, 1), weight);
+    }
+
+    // features never pushed keep default statistics
+    EventwiseStatistics<Real> get(const Feature_e f, const bool weightedMean) const {
+        const auto i = static_cast<size_t>(f);
+        const double n = _n[i];
+        if (n == 0.0) {
+            return {};
+        }
+        const double m2 = _m2[i] / n;
+        const double m3 = _m3[i] / n;
+        const double m4 = _m4[i] / n;
+
+        double mean = _mean[i];
+        if (weightedMean) {
+            mean = (_weightSum[i] > 0.0) ? (_weightedSum[i] / _weightSum[i]) : _weightedSum[i];
+        }
+        return {
+            .mean = static_cast<Real>(mean),
+            .median = static_cast<Real>(_medians[i].get()),
+            .variance = static_cast<Real>(m2),
+            .skewness = static_cast<Real>(m2 == 0.0 ? 0.0 : m3 / std::pow(m2, 1.5)),
+            .kurtosis = static_cast<Real>(m2 == 0.0 ? -3.0 : m4 / (m2 * m2) - 3.0)
+        };
+    }
+
+private:
+    std::array<double, NumSlots> _n {}, _mean {}, _m2 {}, _m3 {}, _m4 {}, _weightedSum {}, _weightSum {};
+    std::array<P2Median, NumSlots> _medians {};
+    bool _estimateMedian;
+};
+
+} // namespace nvs::analysis
@@ -0,0 +1,130 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "StreamingFileAnalyzer.h"
+#include <atomic>
+#include <functional>
+#include <thread>
+
+namespace nvs::analysis {
+
+namespace {
+
+constexpr int waitTimeoutMs {100};
+
+// returns the n samples from position on, valid until the next call; nullptr if they could not be read
+using ReadChunkFn = std::function<const float *(juce::int64 position, int n)>;
+
+std::optional<StreamingAnalysisStats> analyzeStreaming(const juce::int64 length, const ReadChunkFn &readChunk,
+                                                       AnalyzerSettings const &settings,
+                                                       LiveAnalyzer::EventCallback onEvent,
+                                                       const int windowSizeInSamples,
+                                                       const ShouldExitFn &shouldExit)
+{
+    jassert (0 < windowSizeInSamples);
+
+    StreamingAnalysisStats stats;
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    LiveAnalyzer live(settings, [&](LiveAnalyzer::Event const &event) {
+        if (stats.numEvents++ == 0) {
+            stats.secondsToFirstEvent = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+        }
+        if (onEvent) {
+            onEvent(event);
+        }
+    }, windowSizeInSamples);
+
+    // the FIFO holds a few chunks, so the decoder can fill one while the analyzer drains another
+    const int chunkSize = std::max(1, windowSizeInSamples / 4);
+    std::atomic<juce::int64> numDecoded {0};
+    std::atomic<bool> decodeFinished {false}, decodeFailed {false}, stop {false};
+    juce::WaitableEvent dataAvailable, spaceAvailable;
+
+    std::thread decoder([&] {
+        for (juce::int64 position = 0; position < length && !stop.load(); ) {
+            const auto n = static_cast<int>(std::min<juce::int64>(chunkSize, length - position));
+            const float *samples = readChunk(position, n);
+            if (samples == nullptr) {
+                decodeFailed.store(true);
+                break;
+            }
+            for (int pushed = 0; pushed < n && !stop.load(); ) {
+                // push only what fits, so nothing is dropped; wait for the analyzer otherwise
+                if (const int free = std::min(live.getFreeSpace(), n - pushed); free > 0) {
+                    pushed += live.pushAudio(samples + pushed, free);
+                    dataAvailable.signal();
+                } else {
+                    spaceAvailable.wait(waitTimeoutMs);
+                }
+            }
+            position += n;
+            numDecoded.store(position);
+        }
+        decodeFinished.store(true);
+        dataAvailable.signal();
+    });
+
+    bool stoppedEarly {false};
+    while (true) {
+        const bool finished = decodeFinished.load();    // everything pushed before this is processed below
+        live.process();
+        spaceAvailable.signal();
+        if (finished) {
+            break;
+        }
+        if (shouldExit()) {
+            stoppedEarly = true;
+            break;
+        }
+        dataAvailable.wait(waitTimeoutMs);
+    }
+    stop.store(true);
+    spaceAvailable.signal();
+    decoder.join();
+
+    if (stoppedEarly || decodeFailed.load()) {
+        if (decodeFailed.load()) {
+            std::cerr << "analyzeFileStreaming: failed to decode at sample " << numDecoded.load() << "\n";
+        }
+        return std::nullopt;
+    }
+    live.flush();
+    jassert (live.getNumDroppedSamples() == 0);
+
+    stats.numSamplesDecoded = numDecoded.load();
+    stats.seconds = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+    return stats;
+}
+
+}   // anonymous namespace
+
+std::optional<StreamingAnalysisStats> analyzeFileStreaming(juce::AudioFormatReader &reader,
+                                                           AnalyzerSettings const &settings,
+                                                           LiveAnalyzer::EventCallback onEvent,
+                                                           const int windowSizeInSamples,
+                                                           const ShouldExitFn &shouldExit)
+{
+    jassert (juce::approximatelyEqual(reader.sampleRate, settings.analysis.sampleRate));
+    // only the decoder thread reads, into a buffer reused for every chunk
+    juce::AudioBuffer<float> chunk(1, std::max(1, windowSizeInSamples / 4));
+    const auto readChunk = [&](const juce::int64 position, const int n) -> const float * {
+        return reader.read(&chunk, 0, n, position, true, true) ? chunk.getReadPointer(0) : nullptr;
+    };
+    return analyzeStreaming(reader.lengthInSamples, readChunk, settings, std::move(onEvent), windowSizeInSamples, shouldExit);
+}
+
+std::optional<StreamingAnalysisStats> analyzeSamplesStreaming(const std::span<const float> samples,
+                                                              AnalyzerSettings const &settings,
+                                                              LiveAnalyzer::EventCallback onEvent,
+                                                              const int windowSizeInSamples,
+                                                              const ShouldExitFn &shouldExit)
+{
+    const auto readChunk = [samples](const juce::int64 position, int) -> const float * {
+        return samples.data() + position;
+    };
+    return analyzeStreaming(static_cast<juce::int64>(samples.size()), readChunk, settings, std::move(onEvent),
+                            windowSizeInSamples, shouldExit);
+}
+
+}   // namespace nvs::analysis
@@ -0,0 +1,46 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <optional>
+#include <span>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "LiveAnalyzer.h"
+#include "RunLoopStatus.h"
+
+namespace nvs::analysis {
+
+struct StreamingAnalysisStats {
+    juce::int64 numSamplesDecoded {0};
+    juce::int64 numEvents {0};
+    double secondsToFirstEvent {-1.0};  // from the start of decoding; negative if there were no events
+    double seconds {0.0};
+};
+
+/**
+ * Analyzes a file of any length while it is decoded, rather than after decoding it whole.
+ * A decoder thread reads the first channel a chunk at a time into a LiveAnalyzer's FIFO, waiting when it is full, while
+ * the calling thread detects onsets and describes events as the audio arrives, so the first events are emitted after
+ * the first chunk. Decoded audio in flight is bounded by windowSizeInSamples and the analysis itself keeps only a few
+ * frames, so memory does not grow with the file; sample positions are 64-bit throughout.
+ *
+ * settings.analysis.sampleRate must be the reader's. Onsets and events are as LiveAnalyzer picks them, not as the
+ * offline Analyzer would. Returns nullopt if decoding failed or shouldExit stopped it early.
+ */
+std::optional<StreamingAnalysisStats> analyzeFileStreaming(juce::AudioFormatReader &reader,
+                                                           AnalyzerSettings const &settings,
+                                                           LiveAnalyzer::EventCallback onEvent,
+                                                           int windowSizeInSamples,
+                                                           const ShouldExitFn &shouldExit);
+
+// as analyzeFileStreaming, over samples already in memory (e.g. MappedAudioFile::getFloatSamples), which are read in
+// place rather than decoded
+std::optional<StreamingAnalysisStats> analyzeSamplesStreaming(std::span<const float> samples,
+                                                              AnalyzerSettings const &settings,
+                                                              LiveAnalyzer::EventCallback onEvent,
+                                                              int windowSizeInSamples,
+                                                              const ShouldExitFn &shouldExit);
+
+}   // namespace nvs::analysis
@@ -27,6 +27,8 @@ STRAXIOMIZE(NormalizedOnsets);
 STRAXIOMIZE(TimbreMeasurements);
 
 STRAXIOMIZE(numThreads);
+STRAXIOMIZE(requestedFeatures);
+STRAXIOMIZE(requestedStatistics);
 STRAXIOMIZE(frameSize);
 STRAXIOMIZE(hopSize);
 STRAXIOMIZE(windowingType);
@@ -72,6 +74,11 @@ STRAXIOMIZE(Onset);
 STRAXIOMIZE(segmentation);
 STRAXIOMIZE(Event);
 STRAXIOMIZE(Uniform);
+STRAXIOMIZE(rateConversion);
+STRAXIOMIZE(Resample);
+STRAXIOMIZE(Native);
+STRAXIOMIZE(Decimate);
+STRAXIOMIZE(fusedDetection);
 STRAXIOMIZE(alpha);
 STRAXIOMIZE(numFrames_shortOnsetFilter);
 STRAXIOMIZE(silenceThreshold);
@@ -83,6 +90,7 @@ STRAXIOMIZE(weight_rms);
 STRAXIOMIZE(Pitch);
 STRAXIOMIZE(equalizeLoudness);
 STRAXIOMIZE(yin);
+STRAXIOMIZE(yinFast);
 STRAXIOMIZE(pYin);
 STRAXIOMIZE(chroma);
 STRAXIOMIZE(interpolate);
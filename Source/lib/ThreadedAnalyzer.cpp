@@ -23,8 +23,12 @@ ThreadedAnalyzer::~ThreadedAnalyzer(){
 }
 
 void ThreadedAnalyzer::updateStoredAudio(std::span<float const> wave, const juce::String &audioFileAbsPath) {
-	_inputWave.assign(wave.begin(), wave.end());
+	updateStoredAudio(vecReal(wave.begin(), wave.end()), audioFileAbsPath);
+}
+void ThreadedAnalyzer::updateStoredAudio(vecReal &&wave, const juce::String &audioFileAbsPath) {
+	_inputWave = std::move(wave);
 	_audioFileAbsPath = audioFileAbsPath;
+	_artifacts = StageArtifacts{};
     _onsetAnalysisResult.reset();
     _timbreAnalysisResult.reset();
 }
@@ -45,6 +49,66 @@ void ThreadedAnalyzer::updateSettings(juce::ValueTree &settingsTree, const bool
 	}
 }
 
+std::optional<vecReal> ThreadedAnalyzer::pickOnsets(const ShouldExitFn &shouldExit) {
+    if (_analyzer.getSettings().onset.segmentation == AnalyzerSettings::Onset::Segmentation::Uniform) {
+        return _analyzer.calculateUniformOnsets(_inputWave.size());
+    }
+    // only the peak picking depends on e.g. alpha and silenceThreshold, so the detection matrix is often still valid
+    const auto &keys = _analyzer.getStageKeys();
+    if (!_artifacts.onsetDetectionMatrix.has_value() || _artifacts.onsetDetectionKey != keys.onsetDetection) {
+        _artifacts.onsetDetectionMatrix = _analyzer.calculateOnsetDetectionMatrix(_inputWave, _rls, shouldExit);
+        if (!_artifacts.onsetDetectionMatrix.has_value()) {
+            _artifacts.onsetDetectionKey = {};
+            return std::nullopt;
+        }
+        _artifacts.onsetDetectionKey = keys.onsetDetection;
+    } else {
+        DBG("Threaded Analyzer: onset detection settings unchanged, reusing detection matrix");
+    }
+    return _analyzer.pickOnsets(_artifacts.onsetDetectionMatrix.value());
+}
+
+auto ThreadedAnalyzer::describeEvents(const vecReal &onsetsInSeconds, const StageKeys &keys, const ShouldExitFn &shouldExit)
+-> std::optional<std::vector<FeatureContainer<EventwiseStatistics<Real>>>>
+{
+    if (_artifacts.eventDescriptionKey != keys.eventDescription) {
+        _artifacts.eventDescriptions.clear();
+        _artifacts.eventDescriptionKey = keys.eventDescription;
+    }
+    const auto events = calculateEventViews(_inputWave.size(), onsetsInSeconds, _analyzer.getSettings());
+
+    // an event's description depends only on its samples, so events that survived an onset change are reused
+    auto const eventKey = [](const EventView &e) { return std::pair{e.offset, e.length}; };
+    std::vector<EventView> missing;
+    for (auto const &e : events) {
+        if (!_artifacts.eventDescriptions.contains(eventKey(e))) {
+            missing.push_back(e);
+        }
+    }
+    DBG("Threaded Analyzer: reusing " << (events.size() - missing.size()) << " of " << events.size() << " event descriptions");
+
+    if (!missing.empty()) {
+        const auto described = _analyzer.calculateEventwiseDescriptions(_inputWave, missing, _rls, shouldExit);
+        if (!described.has_value()) {
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < missing.size(); ++i) {
+            _artifacts.eventDescriptions[eventKey(missing[i])] = described.value()[i];
+        }
+    }
+
+    std::vector<FeatureContainer<EventwiseStatistics<Real>>> timbreMeasurements;
+    timbreMeasurements.reserve(events.size());
+    std::map<std::pair<size_t, size_t>, FeatureContainer<EventwiseStatistics<Real>>> current;
+    for (auto const &e : events) {
+        const auto &description = _artifacts.eventDescriptions.at(eventKey(e));
+        timbreMeasurements.push_back(description);
+        current.emplace(eventKey(e), description);
+    }
+    _artifacts.eventDescriptions = std::move(current);     // keep only the current events, so memory stays bounded
+    return timbreMeasurements;
+}
+
 void ThreadedAnalyzer::run() {
 	// first, clear everything so that if any analysis is terminated early, we don't have garbage leftover
     _onsetAnalysisResult.reset();
@@ -67,28 +131,45 @@ void ThreadedAnalyzer::run() {
 		// perform onset analysis
 		_rls.set("Calculating Onsets...");
 	    const String audioHash = util::hashAudioData(_inputWave);
-
-	    const auto unnormalizedOnsets = [this, shouldExit, audioHash]()-> vecReal {
-	        const auto onsetOpt = _analyzer.calculateOnsetsInSeconds(_inputWave, _rls, shouldExit);
-		    jassert(onsetOpt.has_value());
-		    if (onsetOpt.value().empty()) {
-		        DBG("Threaded Analyzer: zero onsets... returning");
-		        sendChangeMessage();
-		        return {};
-		    }
-
-		    _onsetAnalysisResult = std::make_shared<OnsetAnalysisResult>(onsetOpt.value(), audioHash, _audioFileAbsPath);
-
-		    auto const sr = _analyzer.getAnalyzedFileSampleRate();
-		    const auto lengthInSeconds = getLengthInSeconds(_inputWave.size(), sr);
-
-		    filterOnsets(_onsetAnalysisResult->onsets, lengthInSeconds);
-		    forceMinimumOnsets(_onsetAnalysisResult->onsets, 4, lengthInSeconds);
-
-		    const auto retval = _onsetAnalysisResult->onsets;
+	    if (_artifacts.audioHash != audioHash) {
+	        _artifacts = StageArtifacts{};
+	        _artifacts.audioHash = audioHash;
+	    }
+	    const StageKeys keys = _analyzer.getStageKeys();
+
+	    const auto unnormalizedOnsets = [this, shouldExit, audioHash, &keys]()-> vecReal {
+	        auto const sr = _analyzer.getAnalyzedFileSampleRate();
+	        const auto lengthInSeconds = getLengthInSeconds(_inputWave.size(), sr);
+
+	        // onsets are kept (in memory and in the cache) already filtered and forced to the minimum count, i.e. before normalization
+	        if (_artifacts.onsetPickingKey != keys.onsetPicking || _artifacts.onsets.empty()) {
+	            auto onsets = _cache ? _cache->loadOnsets(audioHash, keys.onsetPicking) : std::nullopt;
+	            if (onsets.has_value()) {
+	                DBG("Threaded Analyzer: onsets loaded from cache");
+	            } else {
+	                onsets = pickOnsets(shouldExit);
+	                if (!onsets.has_value() || onsets->empty()) {
+	                    DBG("Threaded Analyzer: zero onsets... returning");
+	                    sendChangeMessage();
+	                    return {};
+	                }
+	                filterOnsets(onsets.value(), lengthInSeconds);
+	                forceMinimumOnsets(onsets.value(), 4, lengthInSeconds);
+	                if (_cache) {
+	                    _cache->storeOnsets(audioHash, keys.onsetPicking, onsets.value());
+	                }
+	            }
+	            _artifacts.onsets = std::move(onsets.value());
+	            _artifacts.onsetPickingKey = keys.onsetPicking;
+	        } else {
+	            DBG("Threaded Analyzer: onset settings unchanged, reusing onsets");
+	        }
+
+	        _onsetAnalysisResult = std::make_shared<OnsetAnalysisResult>(_artifacts.onsets, audioHash, _audioFileAbsPath,
+	                                                                     _inputWave.size());
 		    normalizeOnsets(_onsetAnalysisResult->onsets, lengthInSeconds);
 		    sendChangeMessage();
-	        return retval;
+	        return _artifacts.onsets;
 	    }();
 	    if (unnormalizedOnsets.empty()) {
 	        DBG("Threaded Analyzer: zero onsets... returning");
@@ -98,14 +179,23 @@ void ThreadedAnalyzer::run() {
         // perform onsetwise BFCC analysis
 		_rls.set("Calculating Onsetwise TimbreSpace...");
 	    {
-	        const auto timbreMeasurementsOpt = _analyzer.calculateOnsetwiseTimbreSpace(_inputWave, unnormalizedOnsets, _rls, shouldExit);
-		    if (!timbreMeasurementsOpt.has_value()) {
-		        DBG("no timbre measurement accomplished, likely due to early exit");
-		        sendChangeMessage();
-		        return;
-		    }
-
-		    _timbreAnalysisResult.emplace(timbreMeasurementsOpt.value(), audioHash, _audioFileAbsPath);
+	        const String timbreKey = keys.onsetPicking + "|" + keys.eventDescription;
+	        auto timbreMeasurementsOpt = _cache ? _cache->loadTimbre(audioHash, timbreKey) : std::nullopt;
+	        if (timbreMeasurementsOpt.has_value()) {
+	            DBG("Threaded Analyzer: timbre measurements loaded from cache");
+	        } else {
+	            timbreMeasurementsOpt = describeEvents(unnormalizedOnsets, keys, shouldExit);
+	            if (!timbreMeasurementsOpt.has_value()) {
+	                DBG("no timbre measurement accomplished, likely due to early exit");
+	                sendChangeMessage();
+	                return;
+	            }
+	            if (_cache) {
+	                _cache->storeTimbre(audioHash, timbreKey, timbreMeasurementsOpt.value());
+	            }
+	        }
+
+		    _timbreAnalysisResult.emplace(std::move(timbreMeasurementsOpt.value()), audioHash, _audioFileAbsPath);
 		    // only NOW do we send change message, and its a single message which should properly cause ALL data to be visualized etc.
 		    sendChangeMessage();
 	    }
@@ -10,6 +10,7 @@
 
 #pragma once
 #include "Analyzer.h"
+#include "AnalysisCache.h"
 #include "OnsetAnalysis/OnsetAnalysisResult.h"
 #include "TimbreAnalysis/TimbreAnalysisResult.h"
 #include <juce_core/juce_core.h>
@@ -29,6 +30,8 @@ public:
     ~ThreadedAnalyzer() override;
     //===============================================================================
     void updateStoredAudio(std::span<float const> wave, const juce::String &audioFileAbsPath);
+    // takes the wave without copying it, e.g. straight from the decoder
+    void updateStoredAudio(vecReal &&wave, const juce::String &audioFileAbsPath);
     void updateSettings(juce::ValueTree &settingsTree, bool attemptFix);
     //===============================================================================
     void stopAnalysis() { signalThreadShouldExit(); }
@@ -47,17 +50,39 @@ public:
     RunLoopStatus &getStatus() noexcept { return _rls; }
     String getSettingsHash() const noexcept { return _analyzer.getSettingsHash(); }
     //===============================================================================
+    // results are looked up in and stored to this cache, keyed by (audio hash, settings hash). nullptr (the default)
+    // disables caching.
+    void setCache(std::shared_ptr<AnalysisCache> cache) { _cache = std::move(cache); }
+    std::shared_ptr<AnalysisCache> getCache() const { return _cache; }
+    //===============================================================================
 private:
     Analyzer _analyzer;
     vecReal _inputWave;
     std::shared_ptr<OnsetAnalysisResult> _onsetAnalysisResult;
     std::optional<TimbreAnalysisResult> _timbreAnalysisResult;
+    std::shared_ptr<AnalysisCache> _cache;
 
     String _audioFileAbsPath {};
 
     RunLoopStatus _rls;
 
+    // results of each stage of the last run on this audio, so a rerun only recomputes stages whose StageKeys changed
+    struct StageArtifacts {
+        String audioHash;
+        String onsetDetectionKey;
+        std::optional<array2dReal> onsetDetectionMatrix;
+        String onsetPickingKey;
+        vecReal onsets;     // filtered, not normalized
+        String eventDescriptionKey;
+        std::map<std::pair<size_t, size_t>, FeatureContainer<EventwiseStatistics<Real>>> eventDescriptions;   // by (offset, length)
+    } _artifacts;
+
     void run() override;
+    // onsets picked from the (possibly reused) detection matrix, or uniform ones. nullopt if stopped early.
+    std::optional<vecReal> pickOnsets(const ShouldExitFn &shouldExit);
+    // eventwise descriptions of the events between these onsets, describing only events not already described
+    std::optional<std::vector<FeatureContainer<EventwiseStatistics<Real>>>>
+    describeEvents(const vecReal &onsetsInSeconds, const StageKeys &keys, const ShouldExitFn &shouldExit);
 };
 
 }
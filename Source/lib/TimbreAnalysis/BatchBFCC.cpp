@@ -0,0 +1,199 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "BatchBFCC.h"
+#include <iostream>
+#include <map>
+#include <mutex>
+
+namespace nvs::analysis {
+
+namespace {
+constexpr Real silenceCutoff {1e-10f};    // as Essentia's pow2db/amp2db: quieter bands are floored here
+
+const std::map<std::string, int> dctTypeStringToInt {
+        { "typeII",  2 },
+        { "typeIII", 3 }
+};
+
+bool isPowerSpectrum(AnalyzerSettings const &settings) {
+    return settings.bfcc.spectrumType == "power";
+}
+
+juce::String getLogType(AnalyzerSettings const &settings, juce::String const &logType) {
+    if (logType.isNotEmpty()) {
+        jassert (logType == "dbpow" || logType == "dbamp");
+        return logType;
+    }
+    return isPowerSpectrum(settings) ? "dbpow" : "dbamp";
+}
+
+juce::String getTablesKey(AnalyzerSettings const &settings, juce::String const &logType) {
+    auto const &b = settings.bfcc;
+    return juce::StringArray {
+        juce::String(settings.analysis.frameSize), juce::String(settings.analysis.sampleRate), b.dctType,
+        juce::String(b.highFrequencyBound), juce::String(b.liftering), juce::String(b.lowFrequencyBound), b.normalize,
+        juce::String(b.numBands), juce::String(b.numCoefficients), b.spectrumType, b.weightingType, logType
+    }.joinIntoString("|");
+}
+
+std::shared_ptr<const BatchBFCC::Tables> createTables(AnalyzerSettings const &settings, juce::String const &logType) {
+    const auto numBins = static_cast<size_t>(settings.analysis.frameSize) + 1;
+    const auto numBands = settings.bfcc.numBands;
+    // the timbre frames hold NumBFCC coefficients whatever numCoefficients says, and a DCT has at most as many
+    // outputs as inputs; columns past numBands stay zero
+    const auto numCoefficients = std::min(NumBFCC, numBands);
+    auto tables = std::make_shared<BatchBFCC::Tables>();
+    tables->logScale = logType == "dbpow" ? 10.f : 20.f;
+
+    // the filterbank, one bin at a time through BFCC's bands
+    const auto bfcc = createEssentiaBFCC(settings, logType);
+    vecReal spectrum(numBins, 0.f), bands, coefficients;
+    bfcc->input("spectrum").set(spectrum);
+    bfcc->output("bands").set(bands);
+    bfcc->output("bfcc").set(coefficients);
+
+    std::vector<Eigen::Triplet<Real>> weights;
+    size_t strongestBin {0};
+    Real strongestWeight {0.f};
+    int strongestBand {0};
+    for (size_t k = 0; k < numBins; ++k) {
+        spectrum[k] = 1.f;
+        bfcc->compute();
+        spectrum[k] = 0.f;
+        jassert (static_cast<int>(bands.size()) == numBands);
+        for (int band = 0; band < numBands; ++band) {
+            if (const Real w = bands[static_cast<size_t>(band)]; w != 0.f) {
+                weights.emplace_back(static_cast<int>(k), band, w);
+                if (w > strongestWeight) {
+                    strongestWeight = w;
+                    strongestBin = k;
+                    strongestBand = band;
+                }
+            }
+        }
+    }
+    tables->filterbank.resize(static_cast<Eigen::Index>(numBins), numBands);
+    tables->filterbank.setFromTriplets(weights.begin(), weights.end());
+    tables->filterbank.makeCompressed();
+
+    // a unit bin can't tell weights of |X| from weights of |X|²; a bin of 2 can
+    if (strongestWeight > 0.f) {
+        spectrum[strongestBin] = 2.f;
+        bfcc->compute();
+        spectrum[strongestBin] = 0.f;
+        tables->squaresInput = bands[static_cast<size_t>(strongestBand)] > 3.f * strongestWeight;
+    }
+
+    // the DCT, one band at a time
+    const auto dct = std::unique_ptr<standard::Algorithm>(standardFactory::create("DCT",
+        "inputSize",  numBands,
+        "outputSize", numCoefficients,
+        "dctType",    dctTypeStringToInt.at(settings.bfcc.dctType.toStdString()),
+        "liftering",  settings.bfcc.liftering));
+    vecReal unitBands(static_cast<size_t>(numBands), 0.f), column;
+    dct->input("array").set(unitBands);
+    dct->output("dct").set(column);
+    tables->dct.setZero(numBands, NumBFCC);
+    for (int band = 0; band < numBands; ++band) {
+        unitBands[static_cast<size_t>(band)] = 1.f;
+        dct->compute();
+        unitBands[static_cast<size_t>(band)] = 0.f;
+        for (int c = 0; c < numCoefficients; ++c) {
+            tables->dct(band, c) = column[static_cast<size_t>(c)];
+        }
+    }
+
+    // check the whole chain against BFCC once, on a spectrum with energy in every band
+    for (size_t k = 0; k < numBins; ++k) {
+        spectrum[k] = 1e-3f * static_cast<Real>(1 + (k * 7919) % 1000);
+    }
+    bfcc->compute();
+    Eigen::Map<const Eigen::Matrix<Real, 1, Eigen::Dynamic>> s(spectrum.data(), static_cast<Eigen::Index>(numBins));
+    const Eigen::Matrix<Real, 1, Eigen::Dynamic> b = tables->squaresInput ? Eigen::Matrix<Real, 1, Eigen::Dynamic>(s.cwiseAbs2() * tables->filterbank)
+                                                                         : Eigen::Matrix<Real, 1, Eigen::Dynamic>(s * tables->filterbank);
+    const Eigen::Matrix<Real, 1, Eigen::Dynamic> c = (b.array().max(silenceCutoff).log10() * tables->logScale).matrix() * tables->dct;
+    Real maxDifference {0.f};
+    for (int i = 0; i < std::min(numCoefficients, static_cast<int>(coefficients.size())); ++i) {
+        maxDifference = std::max(maxDifference, std::abs(c[i] - coefficients[static_cast<size_t>(i)]));
+    }
+    if (maxDifference > 1e-2f) {
+        std::cerr << "BatchBFCC: differs from Essentia's BFCC by up to " << maxDifference << "\n";
+        jassertfalse;
+    }
+    return tables;
+}
+}   // anonymous namespace
+
+std::unique_ptr<standard::Algorithm> createEssentiaBFCC(AnalyzerSettings const &settings, juce::String const &logType) {
+    auto const spectrumTypeStr = settings.bfcc.spectrumType.toStdString();
+    return std::unique_ptr<standard::Algorithm>(standardFactory::create (
+        "BFCC",
+        "dctType",             dctTypeStringToInt.at(settings.bfcc.dctType.toStdString()),
+        "highFrequencyBound",  settings.bfcc.highFrequencyBound,
+        "inputSize",           settings.analysis.frameSize + 1,
+        "liftering",           settings.bfcc.liftering,
+        "logType",             getLogType(settings, logType).toStdString(),
+
+        "lowFrequencyBound",   settings.bfcc.lowFrequencyBound,
+        "normalize",           settings.bfcc.normalize.toStdString(),
+        "numberBands",         settings.bfcc.numBands,
+        "numberCoefficients",  settings.bfcc.numCoefficients,
+        "sampleRate",          static_cast<float>(settings.analysis.sampleRate),
+        "type",                spectrumTypeStr,
+        "weighting",           settings.bfcc.weightingType.toStdString()
+        ));
+}
+
+BatchBFCC::BatchBFCC(AnalyzerSettings const &settings, juce::String const &logType)
+{
+    static std::mutex mutex;
+    static std::map<juce::String, std::shared_ptr<const Tables>> tablesByConfiguration;
+
+    const auto resolvedLogType = getLogType(settings, logType);
+    const auto key = getTablesKey(settings, resolvedLogType);
+    const std::lock_guard lock(mutex);
+    auto &tables = tablesByConfiguration[key];
+    if (tables == nullptr) {
+        tables = createTables(settings, resolvedLogType);
+    }
+    _tables = tables;
+}
+
+int BatchBFCC::getNumCoefficients() const {
+    return static_cast<int>(_tables->dct.cols());
+}
+
+void BatchBFCC::compute(FeatureMatrix<Real> const &spectra, FeatureMatrix<Real> &frames)
+{
+    const auto numFrames = static_cast<Eigen::Index>(spectra.numRows());
+    const auto numCoefficients = static_cast<Eigen::Index>(getNumCoefficients());
+    if (spectra.numRows() != frames.numRows()
+        || static_cast<Eigen::Index>(spectra.numColumns()) != _tables->filterbank.rows()
+        || static_cast<Eigen::Index>(frames.numColumns()) < numCoefficients)
+    {
+        std::cerr << "BatchBFCC: " << spectra.numRows() << " spectra of " << spectra.numColumns() << " bins don't fit "
+                  << frames.numRows() << " frames of " << frames.numColumns() << " columns\n";
+        jassertfalse;
+        return;
+    }
+    if (numFrames == 0) {
+        return;
+    }
+
+    const Eigen::Map<const RowMajorMatrix> s(spectra.data(), numFrames, static_cast<Eigen::Index>(spectra.numColumns()));
+    if (_tables->squaresInput) {
+        _bands.noalias() = s.cwiseAbs2() * _tables->filterbank;
+    } else {
+        _bands.noalias() = s * _tables->filterbank;
+    }
+    _bands = _bands.array().max(silenceCutoff).log10() * _tables->logScale;
+
+    // straight into the frames' first columns
+    Eigen::Map<RowMajorMatrix, 0, Eigen::OuterStride<>> cepstra(frames.data(), numFrames, numCoefficients,
+                                                                 Eigen::OuterStride<>(static_cast<Eigen::Index>(frames.numColumns())));
+    cepstra.noalias() = _bands * _tables->dct;
+}
+
+} // namespace nvs::analysis
@@ -0,0 +1,58 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "AnalysisUsing.h"
+#include "../FeatureMatrix.h"
+#include "../Features.h"
+#include "../Settings.h"
+
+namespace nvs::analysis {
+
+// Essentia's BFCC, as the timbre path configures it from settings.bfcc (frameSize + 1 spectrum bins).
+// logType overrides the log compression ("dbpow" or "dbamp"), which otherwise follows settings.bfcc.spectrumType
+std::unique_ptr<standard::Algorithm> createEssentiaBFCC(AnalyzerSettings const &settings,
+                                                        juce::String const &logType = {});
+
+/**
+ * BFCC for a block of frames at once: the Bark filterbank is a sparse bins x bands matrix and the DCT (with liftering)
+ * a dense bands x coefficients one, so a block's cepstra are one sparse product, an elementwise log and one GEMM,
+ * instead of a filterbank pass and a small DCT per frame.
+ *
+ * Both matrices are read out of Essentia itself, by passing unit spectra through the BFCC configured from settings
+ * (and unit bands through its DCT), so band shapes, normalization, weighting and DCT type are Essentia's by
+ * construction. This costs one BFCC call per spectrum bin, so the tables are shared by every instance with the same
+ * configuration in the process.
+ * The tables always give NumBFCC coefficients, the columns the timbre frames reserve for them, whatever
+ * settings.bfcc.numCoefficients is (coefficients past numBands are zero).
+ */
+class BatchBFCC {
+public:
+    // uses frameSize, sampleRate and settings.bfcc; logType as for createEssentiaBFCC
+    explicit BatchBFCC(AnalyzerSettings const &settings, juce::String const &logType = {});
+
+    int getNumCoefficients() const;   // NumBFCC
+
+    // spectra: one row per frame, frameSize + 1 columns. writes each frame's coefficients into the first
+    // getNumCoefficients() columns of the same row of frames. blocks that don't fit are rejected, writing nothing
+    void compute(FeatureMatrix<Real> const &spectra, FeatureMatrix<Real> &frames);
+
+    struct Tables {
+        Eigen::SparseMatrix<Real> filterbank;   // bins x bands
+        Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic> dct;   // bands x coefficients
+        bool squaresInput {false};  // whether the bands weigh the squared spectrum
+        Real logScale {10.f};       // 10 for dbpow, 20 for dbamp
+    };
+
+private:
+    using RowMajorMatrix = Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    std::shared_ptr<const Tables> _tables;
+    RowMajorMatrix _bands;
+};
+
+} // namespace nvs::analysis
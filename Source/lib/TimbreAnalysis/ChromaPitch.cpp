@@ -0,0 +1,110 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "ChromaPitch.h"
+#include <array>
+#include <numeric>
+
+namespace nvs::analysis {
+
+namespace {
+Real frequencyToMidi(const Real f) {
+    return 69.f + 12.f * std::log2(f / 440.f);
+}
+Real logOf(const Real e) {
+    return std::log(std::max(e, 1e-30f));
+}
+}   // anonymous namespace
+
+ChromaPitch::ChromaPitch(AnalyzerSettings const &settings)
+:   _minMidi(frequencyToMidi(static_cast<Real>(settings.pitch.minFrequency)))
+,   _binHz(static_cast<Real>(settings.analysis.sampleRate) / static_cast<Real>(2 * settings.analysis.frameSize))
+,   _spectrumIsPower(settings.bfcc.spectrumType == "power")
+{
+    const auto numSpectrumBins = static_cast<size_t>(settings.analysis.frameSize) + 1;
+    const auto minFrequency = static_cast<Real>(settings.pitch.minFrequency);
+    const auto maxFrequency = static_cast<Real>(settings.pitch.maxFrequency);
+
+    _firstSpectrumBin = static_cast<size_t>(std::ceil(minFrequency / _binHz));
+    for (size_t k = std::max<size_t>(_firstSpectrumBin, 1); k < numSpectrumBins; ++k) {
+        const Real frequency = static_cast<Real>(k) * _binHz;
+        if (frequency > maxFrequency) {
+            break;
+        }
+        const Real position = (frequencyToMidi(frequency) - _minMidi) * binsPerSemitone;
+        const Real lower = std::floor(position);
+        _pitchBin.push_back(static_cast<juce::uint32>(lower));
+        _upperWeight.push_back(position - lower);
+    }
+    _firstSpectrumBin = std::max<size_t>(_firstSpectrumBin, 1);
+    const size_t numPitchBins = _pitchBin.empty() ? 0 : static_cast<size_t>(_pitchBin.back()) + 2;
+    _pitchEnergy.resize(numPitchBins);
+    _chroma.resize(binsPerOctave);
+}
+
+auto ChromaPitch::compute(const std::span<const Real> spectrum) -> Estimate
+{
+    jassert (_firstSpectrumBin + _pitchBin.size() <= spectrum.size());
+    std::fill(_pitchEnergy.begin(), _pitchEnergy.end(), 0.f);
+    const Real *bins = spectrum.data() + _firstSpectrumBin;
+    for (size_t k = 0; k < _pitchBin.size(); ++k) {
+        const Real e = _spectrumIsPower ? bins[k] : bins[k] * bins[k];
+        const Real upper = e * _upperWeight[k];
+        _pitchEnergy[_pitchBin[k]] += e - upper;
+        _pitchEnergy[_pitchBin[k] + 1] += upper;
+    }
+
+    std::fill(_chroma.begin(), _chroma.end(), 0.f);
+    for (size_t p = 0; p < _pitchEnergy.size(); ++p) {
+        _chroma[p % binsPerOctave] += _pitchEnergy[p];
+    }
+    const Real total = std::accumulate(_chroma.begin(), _chroma.end(), 0.f);
+    if (total <= 0.f) {
+        return {};
+    }
+    const auto pitchClass = static_cast<size_t>(std::distance(_chroma.begin(), std::max_element(_chroma.begin(), _chroma.end())));
+    const auto around = [](vecReal const &v, const size_t i, const bool cyclic) {
+        const size_t size = v.size();
+        const Real below = (i > 0) ? v[i - 1] : (cyclic ? v[size - 1] : 0.f);
+        const Real above = (i + 1 < size) ? v[i + 1] : (cyclic ? v[0] : 0.f);
+        return std::array<Real, 3> { below, v[i], above };
+    };
+    const auto classEnergy = around(_chroma, pitchClass, true);
+
+    // the octave of the class holding most of its energy (within a semitone)
+    size_t best = pitchClass;
+    Real bestEnergy {-1.f};
+    for (size_t p = pitchClass; p < _pitchEnergy.size(); p += binsPerOctave) {
+        const auto [below, at, above] = around(_pitchEnergy, p, false);
+        if (const Real e = below + at + above; e > bestEnergy) {
+            bestEnergy = e;
+            best = p;
+        }
+    }
+    // the frequency itself from the strongest spectrum bin within a semitone of it, interpolated on log energy: pitch
+    // bins are coarser than spectrum bins at the top of the range, and sparser at the bottom
+    size_t peak {0};
+    Real peakEnergy {-1.f};
+    for (size_t k = 0; k < _pitchBin.size(); ++k) {
+        const auto p = static_cast<int>(_pitchBin[k]) + (_upperWeight[k] >= 0.5f ? 1 : 0);
+        if (std::abs(p - static_cast<int>(best)) <= binsPerSemitone && bins[k] > peakEnergy) {
+            peakEnergy = bins[k];
+            peak = k;
+        }
+    }
+    peak += _firstSpectrumBin;
+    auto spectrumBin = static_cast<Real>(peak);
+    if (peak > 0 && peak + 1 < spectrum.size()) {
+        const Real below = logOf(spectrum[peak - 1]), at = logOf(spectrum[peak]), above = logOf(spectrum[peak + 1]);
+        if (const Real curvature = below - 2.f * at + above; curvature < 0.f) {
+            spectrumBin += std::clamp(0.5f * (below - above) / curvature, -0.5f, 0.5f);
+        }
+    }
+    return {
+        .frequency = spectrumBin * _binHz,
+        .confidence = (classEnergy[0] + classEnergy[1] + classEnergy[2]) / total
+    };
+}
+
+}   // namespace nvs::analysis
@@ -0,0 +1,47 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <span>
+
+#include "AnalysisUsing.h"
+#include "../Settings.h"
+
+namespace nvs::analysis {
+
+/**
+ * Pitch from a chromagram of the frame's spectrum (the one the timbre path computes): the energy between
+ * pitch.minFrequency and pitch.maxFrequency is gathered into pitch bins, folded into pitch classes, and the strongest
+ * class is placed in the octave holding most of its energy, at the spectral peak there. Where YIN follows the period of the strongest source,
+ * this follows the dominant pitch class, which holds up better on chords and noisy tonal material, at the cost of
+ * octave errors on sparse spectra.
+ *
+ * Each spectrum bin's pitch bin and interpolation weight are worked out once, so a frame costs one pass over its bins.
+ */
+class ChromaPitch {
+public:
+    // uses frameSize, sampleRate, pitch.minFrequency/maxFrequency, and bfcc.spectrumType to know what the spectrum holds
+    explicit ChromaPitch(AnalyzerSettings const &settings);
+
+    struct Estimate {
+        Real frequency {0.f};   // Hz; 0 for a frame without energy in range
+        Real confidence {0.f};  // the share of the in-range energy in the chosen pitch class
+    };
+    // spectrum: frameSize + 1 bins, of the frame zero-padded to 2 * frameSize
+    Estimate compute(std::span<const Real> spectrum);
+
+private:
+    static constexpr int binsPerSemitone {3};
+    static constexpr int binsPerOctave {12 * binsPerSemitone};
+
+    const Real _minMidi;
+    const Real _binHz;
+    const bool _spectrumIsPower;
+    size_t _firstSpectrumBin {0};
+    std::vector<juce::uint32> _pitchBin;    // per spectrum bin from _firstSpectrumBin: the lower pitch bin it falls between
+    vecReal _upperWeight;                   // and the share of its energy going to the pitch bin above
+    vecReal _pitchEnergy, _chroma;
+};
+
+}   // namespace nvs::analysis
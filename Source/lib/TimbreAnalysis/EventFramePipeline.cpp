@@ -0,0 +1,352 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "EventFramePipeline.h"
+#include "../StringAxiom.h"
+
+namespace nvs::analysis {
+
+namespace {
+const std::map<std::string, std::string> pitchAlgoNicknameMap {
+        {"yin", "PitchYin"}
+};	// for now we only handle this
+
+Real frequencyToMidi(const Real x) {
+    if (x == 0.f) {
+        return 0.0f;
+    }
+    return 69.f + 12.f * std::log2(x / 440.f);
+}
+
+/**
+ * Cuts frames straight out of an event view, applying the split fades as samples are copied, so events never need to
+ * be materialized. Frame positions match FrameCutter with startFromZero, lastFrameToEndOfFile and a
+ * validFrameThresholdRatio of 0: a frame starts every hopSize samples while the start lies inside the event,
+ * zero-padded past its end.
+ */
+class EventFrameCutter {
+public:
+    EventFrameCutter(std::span<Real const> event, const int frameSize, const int hopSize,
+                     const int fadeInSamps, const int fadeOutSamps)
+    :   _event(event)
+    ,   _frameSize(static_cast<size_t>(frameSize))
+    ,   _hopSize(static_cast<size_t>(hopSize))
+    ,   _fadeInSamps(std::min(static_cast<size_t>(fadeInSamps), event.size()))
+    ,   _fadeOutSamps(std::min(static_cast<size_t>(fadeOutSamps), event.size()))
+    {
+        jassert (0 < _hopSize);
+    }
+
+    bool next(vecReal &frame) {
+        if (_start >= _event.size()) {
+            frame.clear();
+            return false;
+        }
+        frame.assign(_frameSize, 0.f);
+        const size_t numValid = std::min(_frameSize, _event.size() - _start);
+        std::copy_n(_event.begin() + static_cast<std::ptrdiff_t>(_start), numValid, frame.begin());
+
+        // only the samples inside the fade regions need a gain
+        const size_t end = _start + numValid;
+        for (size_t i = _start; i < std::min(end, _fadeInSamps); ++i) {
+            frame[i - _start] = _event[i] * fadeGain(i, _event.size(), _fadeInSamps, _fadeOutSamps);
+        }
+        for (size_t i = std::max(_start, _event.size() - _fadeOutSamps); i < end; ++i) {
+            frame[i - _start] = _event[i] * fadeGain(i, _event.size(), _fadeInSamps, _fadeOutSamps);
+        }
+        _start += _hopSize;
+        return true;
+    }
+private:
+    std::span<Real const> _event;
+    size_t _frameSize, _hopSize, _fadeInSamps, _fadeOutSamps;
+    size_t _start {0};
+};
+}   // anonymous namespace
+
+Real fadeGain(const size_t idx, const size_t length, const size_t fadeInSamps, const size_t fadeOutSamps) {
+    Real gain {1.f};
+    if (idx < fadeInSamps) {
+        gain *= static_cast<Real>(idx) / static_cast<Real>(fadeInSamps);
+    }
+    if (const size_t fromEnd = (length - 1) - idx;
+        fromEnd < fadeOutSamps)
+    {
+        gain *= static_cast<Real>(fromEnd) / static_cast<Real>(fadeOutSamps);
+    }
+    return gain;
+}
+
+EventFramePipeline::EventFramePipeline(AnalyzerSettings const &settings)
+:   _settings(settings)
+,   _statistics(settings.request.wants(Statistic::Median))
+{
+    const int frameSize  = settings.analysis.frameSize;
+    const auto sampleRate  = static_cast<float>(settings.analysis.sampleRate);
+    auto const &request = settings.request;
+    const auto wantsAny = [&request](std::initializer_list<Feature_e> features) {
+        return std::any_of(features.begin(), features.end(), [&request](const Feature_e f) { return request.wants(f); });
+    };
+
+    _windowing = std::unique_ptr<standard::Algorithm>(standardFactory::create (
+        "Windowing",
+          "normalized",  false,
+          "size",        frameSize,
+          "zeroPadding", frameSize,
+          "type",        settings.analysis.windowingType.toStdString(),
+          "zeroPhase",   false
+    ));
+
+    // only the chains the requested features need are built. BFCC is also needed for the bfcc0 frame weights of the
+    // (weighted) timbral means
+    const bool wantsDescriptors = wantsAny({ Feature_e::SpectralCentroid, Feature_e::SpectralDecrease,
+        Feature_e::SpectralFlatness, Feature_e::SpectralCrest, Feature_e::SpectralComplexity, Feature_e::StrongPeak });
+    const bool wantsBFCC = request.wantsAnyBFCC() || (wantsDescriptors && request.wants(Statistic::Mean));
+    const bool wantsPitch = wantsAny({ Feature_e::f0, Feature_e::Periodicity });
+    auto const &pitchAlgorithm = settings.pitch.pitchDetectionAlgorithm;
+    const bool pitchFromSpectrum = wantsPitch && (pitchAlgorithm == axiom::tsn::yinFast
+        || pitchAlgorithm == axiom::tsn::pYin || pitchAlgorithm == axiom::tsn::chroma);
+    _describesTimbre = wantsBFCC || wantsDescriptors;
+    if (_describesTimbre || pitchFromSpectrum) {
+        _frontEnd = std::make_unique<SpectralFrontEnd>(frameSize * 2, settings.bfcc.spectrumType == axiom::tsn::power
+                                                                         ? SpectralFrontEnd::Output::Power
+                                                                         : SpectralFrontEnd::Output::Magnitude);
+        _frameBlock = FeatureMatrix<Real>(static_cast<size_t>(frameSize) * 2);
+        _frameBlock.reserveRows(blockFrames);
+        _spectrumBlock = FeatureMatrix<Real>(_frontEnd->getNumColumns());
+        _spectrumBlock.reserveRows(blockFrames);
+        _timbreBlock.reserveRows(blockFrames);
+    }
+    if (wantsBFCC) {
+        _bfcc = std::make_unique<BatchBFCC>(settings);
+        jassert (_bfcc->getNumCoefficients() == NumBFCC);
+    }
+    if (wantsDescriptors) {
+        _descriptors = std::make_unique<SpectralDescriptors>(settings, static_cast<size_t>(frameSize) + 1);
+    }
+
+    // the spectral pitch backends work from the spectrum above
+    if (wantsPitch && pitchAlgorithm == axiom::tsn::yinFast) {
+        _fastYin = std::make_unique<FastYin>(settings);
+    } else if (wantsPitch && pitchAlgorithm == axiom::tsn::pYin) {
+        _pYin = std::make_unique<ProbabilisticYin>(settings);
+    } else if (wantsPitch && pitchAlgorithm == axiom::tsn::chroma) {
+        _chromaPitch = std::make_unique<ChromaPitch>(settings);
+    } else if (wantsPitch) {
+        if (const auto it = pitchAlgoNicknameMap.find(settings.pitch.pitchDetectionAlgorithm.toStdString());
+            it != pitchAlgoNicknameMap.end())
+        {
+            _pitchDetection = std::unique_ptr<standard::Algorithm>(standardFactory::create (it->second,
+                        "frameSize",   frameSize,
+                        "interpolate",  settings.pitch.interpolate,
+                        "maxFrequency", settings.pitch.maxFrequency,
+                        "minFrequency", settings.pitch.minFrequency,
+                        "sampleRate",   settings.analysis.sampleRate,
+                        "tolerance",    settings.pitch.tolerance
+                    ));
+        } else {
+            jassertfalse;   // not implemented
+        }
+    }
+
+    if (request.wants(Feature_e::Loudness)) {
+        if (settings.loudness.equalizeLoudness) {
+            _equalLoudness = std::unique_ptr<standard::Algorithm>(standardFactory::create(
+                    "EqualLoudness",
+                    "sampleRate", sampleRate
+                    ));
+        }
+        _loudness = std::unique_ptr<standard::Algorithm>(standardFactory::create("Loudness"));
+    }
+}
+
+EventFramePipeline &EventFramePipeline::getForCurrentThread(AnalyzerSettings const &settings,
+                                                            juce::String const &settingsHash)
+{
+    struct CachedPipeline {
+        std::unique_ptr<EventFramePipeline> pipeline;
+        juce::String settingsHash;
+        double sampleRate {0.0};
+    };
+    thread_local CachedPipeline cached;
+
+    if (cached.pipeline == nullptr
+        || cached.settingsHash != settingsHash
+        || cached.sampleRate != settings.analysis.sampleRate)
+    {
+        cached.pipeline = std::make_unique<EventFramePipeline>(settings);
+        cached.settingsHash = settingsHash;
+        cached.sampleRate = settings.analysis.sampleRate;
+    }
+    return *cached.pipeline;
+}
+
+FeatureContainer<EventwiseStatistics<Real>> EventFramePipeline::process(std::span<Real const> waveEvent)
+{
+    beginEvent();
+
+    const int frameSize = _settings.analysis.frameSize;
+    const int hopSize = _settings.analysis.hopSize;
+    EventFrameCutter frameCutter(waveEvent, frameSize, hopSize, _settings.split.fadeInSamps, _settings.split.fadeOutSamps);
+
+    // loudness is measured on the equal-loudness filtered event, which has to be framed on its own.
+    // the filter needs the whole (faded) event as a contiguous signal, so only this path copies it.
+    std::optional<EventFrameCutter> loudnessFrameCutter;
+    if (_equalLoudness) {
+        const size_t length = waveEvent.size();
+        const size_t fadeInSamps = std::min(static_cast<size_t>(_settings.split.fadeInSamps), length);
+        const size_t fadeOutSamps = std::min(static_cast<size_t>(_settings.split.fadeOutSamps), length);
+        _fadedEvent.assign(waveEvent.begin(), waveEvent.end());
+        for (size_t i = 0; i < length; ++i) {
+            _fadedEvent[i] *= fadeGain(i, length, fadeInSamps, fadeOutSamps);
+        }
+        _equalLoudness->input("signal").set(_fadedEvent);
+        _equalLoudness->output("signal").set(_filteredEvent);
+        _equalLoudness->compute();
+        loudnessFrameCutter.emplace(_filteredEvent, frameSize, hopSize, 0, 0);
+    }
+
+    vecReal frame, loudnessFrame;
+    while (frameCutter.next(frame)) {
+        if (loudnessFrameCutter) {
+            loudnessFrameCutter->next(loudnessFrame);
+            jassert (loudnessFrame.size() == frame.size());
+        }
+        pushFrame(frame, loudnessFrameCutter ? &loudnessFrame : nullptr);
+    }
+    return endEvent();
+}
+
+void EventFramePipeline::beginEvent() {
+    _statistics.reset();
+    _frameBlock.clearRows();
+    _spectrumBlock.clearRows();
+    _timbreBlock.clearRows();
+    if (_pYin) {
+        _pYin->beginEvent();
+    }
+}
+
+void EventFramePipeline::pushFrame(vecReal const &frame, vecReal const *loudnessFrame)
+{
+    // apply windowing
+    _windowing->input("frame").set(frame);
+    _windowing->output("frame").set(_windowedFrame);
+    _windowing->compute();
+
+    // the spectrum and everything that reads it wait for the rest of the block
+    if (_frontEnd) {
+        _frameBlock.appendRow(_windowedFrame);
+        if (_frameBlock.numRows() == blockFrames) {
+            flushBlock();
+        }
+    }
+
+    if (_pitchDetection) {
+        Real pitch, pitchConfidence;
+        _pitchDetection->input("signal").set(_windowedFrame);
+        _pitchDetection->output("pitch").set(pitch);
+        _pitchDetection->output("pitchConfidence").set(pitchConfidence);
+        _pitchDetection->compute();
+        _statistics.push(Feature_e::f0, frequencyToMidi(pitch));
+        _statistics.push(Feature_e::Periodicity, pitchConfidence);
+    }
+
+    if (_loudness) {
+        // calculate loudness, reusing the windowed frame unless the event was equal-loudness filtered
+        const vecReal *loudnessInput = &_windowedFrame;
+        if (loudnessFrame != nullptr) {
+            _windowing->input("frame").set(*loudnessFrame);
+            _windowing->output("frame").set(_windowedLoudnessFrame);
+            _windowing->compute();
+            loudnessInput = &_windowedLoudnessFrame;
+        }
+        Real loudnessValue;
+        _loudness->input("signal").set(*loudnessInput);
+        _loudness->output("loudness").set(loudnessValue);
+        _loudness->compute();
+        _statistics.push(Feature_e::Loudness, loudnessValue);
+    }
+}
+
+void EventFramePipeline::flushBlock()
+{
+    if (_frameBlock.numRows() == 0) {
+        return;
+    }
+    _frontEnd->compute(_frameBlock, _spectrumBlock);
+
+    for (size_t i = 0; i < _frameBlock.numRows(); ++i) {
+        const auto windowedFrame = _frameBlock.rowSpan(i);
+        const auto spectrum = _spectrumBlock.rowSpan(i);
+        // the spectral descriptors that were not requested stay at zero; BFCC follows for the whole block
+        if (_describesTimbre) {
+            const auto timbreFrame = _timbreBlock.appendRow();
+            if (_descriptors) {
+                _descriptors->compute(spectrum, timbreFrame);
+            }
+        }
+        // pitch from the same windowed frame and spectrum
+        if (_fastYin) {
+            const auto [frequency, confidence] = _fastYin->compute(windowedFrame, spectrum);
+            _statistics.push(Feature_e::f0, frequencyToMidi(frequency));
+            _statistics.push(Feature_e::Periodicity, confidence);
+        } else if (_pYin) {
+            _pYin->pushFrame(windowedFrame, spectrum);    // decoded over the whole event in endEvent
+        } else if (_chromaPitch) {
+            const auto [frequency, confidence] = _chromaPitch->compute(spectrum);
+            _statistics.push(Feature_e::f0, frequencyToMidi(frequency));
+            _statistics.push(Feature_e::Periodicity, confidence);
+        }
+    }
+
+    if (_bfcc) {
+        _bfcc->compute(_spectrumBlock, _timbreBlock);
+    }
+    // each frame's contribution to the eventwise timbre mean is weighted by its energy (bfcc0)
+    const auto bfcc0NormalizationFactor = static_cast<Real>(_settings.bfcc.BFCC0_frameNormalizationFactor);
+    for (size_t i = 0; i < _timbreBlock.numRows(); ++i) {
+        const auto timbreFrame = _timbreBlock.rowSpan(i);
+        const Real frameWeight = _bfcc ? std::exp(timbreFrame[0] * bfcc0NormalizationFactor) : 1.f;
+        _statistics.push(Feature_e::bfcc0, timbreFrame, frameWeight);
+    }
+    _frameBlock.clearRows();
+    _timbreBlock.clearRows();
+}
+
+FeatureContainer<EventwiseStatistics<Real>> EventFramePipeline::endEvent()
+{
+    flushBlock();
+    if (_pYin) {
+        _pYin->endEvent(_pitchTrack, _voicedProbabilities);
+        for (size_t i = 0; i < _pitchTrack.size(); ++i) {
+            _statistics.push(Feature_e::f0, frequencyToMidi(_pitchTrack[i]));
+            _statistics.push(Feature_e::Periodicity, _voicedProbabilities[i]);
+        }
+    }
+
+    FeatureContainer<EventwiseStatistics<Real>> features;
+    auto const &request = _settings.request;
+    for (size_t i = 0; i < features.features.size(); ++i) {
+        const auto f = static_cast<Feature_e>(i);
+        if (!request.wants(f)) {
+            continue;   // left at zero, like the statistics below
+        }
+        auto &statistics = features[f];
+        statistics = _statistics.get(f, static_cast<int>(i) < NumTimbralFeatures);
+        const auto keep = [&request](const Statistic s, Real &value) {
+            if (!request.wants(s)) {
+                value = 0.f;
+            }
+        };
+        keep(Statistic::Mean, statistics.mean);
+        keep(Statistic::Median, statistics.median);
+        keep(Statistic::Variance, statistics.variance);
+        keep(Statistic::Skewness, statistics.skewness);
+        keep(Statistic::Kurtosis, statistics.kurtosis);
+    }
+    return features;
+}
+
+} // namespace nvs::analysis
@@ -0,0 +1,91 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <span>
+
+#include "AnalysisUsing.h"
+#include "../Settings.h"
+#include "../Features.h"
+#include "../StatisticsAccumulator.h"
+#include "../SpectralFrontEnd.h"
+#include "FastYin.h"
+#include "ProbabilisticYin.h"
+#include "ChromaPitch.h"
+#include "SpectralDescriptors.h"
+#include "BatchBFCC.h"
+
+namespace nvs::analysis {
+
+/**
+ * Per-event frame pipeline.
+ * Each frame of an event is cut (from a view into the analyzed wave) and windowed once, and its spectrum is computed once; the same windowed frame and
+ * spectrum are then shared by BFCC, the spectral descriptors, pitch detection and loudness (yinFast, pYin and chroma
+ * take their pitch from the same spectrum; pYin's frames are decoded together when the event ends).
+ * (calculateTimbres, calculatePitchesAndConfidences and calculateLoudnesses each re-frame the whole event.)
+ * The only extra framing happens when loudness is equalized, since EqualLoudness filters the time signal before framing.
+ * Windowed frames are gathered into blocks of blockFrames; when a block fills (or the event ends) its spectra are
+ * computed together by the SpectralFrontEnd into one contiguous matrix, which the spectral descriptors, the spectral
+ * pitch backends and BatchBFCC then read in place, and the block's timbral and pitch statistics are pushed.
+ * Only the algorithms that settings.request's features need are created and run: without pitch or loudness requested,
+ * pitch detection and EqualLoudness are skipped entirely.
+ */
+class EventFramePipeline {
+public:
+    explicit EventFramePipeline(AnalyzerSettings const &settings);
+
+    /**
+     * The calling thread's pipeline, configured for these settings.
+     * Algorithms are created once per worker thread and only rebuilt when the settings hash (or sample rate, which
+     * lives outside the hashed settings tree) changes, instead of going through the factory for every event.
+     */
+    static EventFramePipeline &getForCurrentThread(AnalyzerSettings const &settings, juce::String const &settingsHash);
+
+    /**
+     * Returns eventwise statistics for every requested Feature_e (pitch as MIDI note, periodicity as pitch confidence),
+     * accumulated while frames are produced; unrequested features and statistics are zero. Timbral means are weighted per frame by exp(bfcc0 * BFCC0_frameNormalizationFactor).
+     * waveEvent is an unfaded view into the analyzed wave; the split fades are applied as frames are cut.
+     */
+    FeatureContainer<EventwiseStatistics<Real>> process(std::span<Real const> waveEvent);
+
+    // process, one frame at a time, for events whose audio arrives over time (see LiveAnalyzer):
+    // beginEvent, then pushFrame for each frame of the event (already faded), then endEvent.
+    void beginEvent();
+    // loudnessFrame is the same frame cut from the equal-loudness filtered signal, or nullptr to measure loudness on frame
+    void pushFrame(vecReal const &frame, vecReal const *loudnessFrame = nullptr);
+    FeatureContainer<EventwiseStatistics<Real>> endEvent();
+    bool equalizesLoudness() const { return _equalLoudness != nullptr; }
+
+private:
+    using AlgoPtr = std::unique_ptr<standard::Algorithm>;
+
+    AnalyzerSettings const _settings;
+
+    AlgoPtr _windowing;
+    std::unique_ptr<SpectralFrontEnd> _frontEnd;   // only when a spectrum is needed
+    std::unique_ptr<BatchBFCC> _bfcc;
+    std::unique_ptr<SpectralDescriptors> _descriptors;
+    AlgoPtr _pitchDetection, _equalLoudness, _loudness;
+    // in place of _pitchDetection, for yinFast, pYin and chroma
+    std::unique_ptr<FastYin> _fastYin;
+    std::unique_ptr<ProbabilisticYin> _pYin;
+    std::unique_ptr<ChromaPitch> _chromaPitch;
+    bool _describesTimbre {false};
+
+    EventwiseStatisticsAccumulator _statistics;
+    vecReal _fadedEvent, _filteredEvent;    // scratch for the equal-loudness path, reused across events
+    vecReal _windowedFrame, _windowedLoudnessFrame;    // per-frame scratch
+    // the windowed frames waiting for their spectra, then the block's spectra and rows of timbral features
+    static constexpr size_t blockFrames {64};
+    FeatureMatrix<Real> _frameBlock, _spectrumBlock, _timbreBlock {NumTimbralFeatures};
+    vecReal _pitchTrack, _voicedProbabilities;  // pYin's decoded event
+
+    // spectra of _frameBlock, then the spectral descriptors, spectral pitch, BFCC and their statistics
+    void flushBlock();
+};
+
+// gain of sample idx of an event of the given length, for the linear split fades splitWaveIntoEvents applies
+Real fadeGain(size_t idx, size_t length, size_t fadeInSamps, size_t fadeOutSamps);
+
+} // namespace nvs::analysis
@@ -0,0 +1,118 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "FastYin.h"
+
+namespace nvs::analysis {
+
+FastYin::FastYin(AnalyzerSettings const &settings)
+:   _frameSize(settings.analysis.frameSize)
+,   _sampleRate(static_cast<Real>(settings.analysis.sampleRate))
+    // as PitchYin: periods between sampleRate / maxFrequency and sampleRate / minFrequency, at most half a frame
+,   _tauMin(std::min(static_cast<int>(std::floor(settings.analysis.sampleRate / settings.pitch.maxFrequency)), _frameSize / 2))
+,   _tauMax(std::min(static_cast<int>(std::ceil(settings.analysis.sampleRate / settings.pitch.minFrequency)), _frameSize / 2))
+,   _tolerance(static_cast<Real>(settings.pitch.tolerance))
+,   _interpolate(settings.pitch.interpolate)
+,   _spectrumIsPower(settings.bfcc.spectrumType == "power")
+{
+    jassert (0 < _tauMin && _tauMin < _tauMax);
+    _ifft = std::unique_ptr<standard::Algorithm>(standardFactory::create("IFFT",
+        "size", 2 * _frameSize));
+    _powerSpectrum.resize(static_cast<size_t>(_frameSize) + 1);
+    _energy.resize(static_cast<size_t>(_frameSize) + 1);
+    _difference.resize(getDifferenceLength());
+}
+
+FastYin::~FastYin() = default;
+
+auto FastYin::compute(const std::span<const Real> windowedFrame, const std::span<const Real> spectrum) -> Estimate
+{
+    if (!computeDifference(windowedFrame, spectrum, _difference)) {
+        return {};  // silence
+    }
+    return estimate(_difference);
+}
+
+bool FastYin::computeDifference(const std::span<const Real> windowedFrame, const std::span<const Real> spectrum,
+                                const std::span<Real> difference)
+{
+    const auto n = static_cast<size_t>(_frameSize);
+    jassert (windowedFrame.size() >= n);
+    jassert (spectrum.size() == n + 1);
+    jassert (difference.size() == getDifferenceLength());
+
+    // autocorrelation r(τ) = Σ x_j x_{j+τ}, as the inverse transform of |X|²
+    for (size_t k = 0; k <= n; ++k) {
+        const Real power = _spectrumIsPower ? spectrum[k] : spectrum[k] * spectrum[k];
+        _powerSpectrum[k] = { power, 0.f };
+    }
+    _ifft->input("fft").set(_powerSpectrum);
+    _ifft->output("frame").set(_autocorrelation);
+    _ifft->compute();
+
+    // running energies: _energy[k] = Σ_{j<k} x_j². r(0) is the frame's energy, which also fixes the inverse
+    // transform's scale whatever its normalization
+    _energy[0] = 0.f;
+    for (size_t j = 0; j < n; ++j) {
+        _energy[j + 1] = _energy[j] + windowedFrame[j] * windowedFrame[j];
+    }
+    const Real totalEnergy = _energy[n];
+    if (totalEnergy <= 0.f || _autocorrelation[0] <= 0.f) {
+        std::fill(difference.begin(), difference.end(), 1.f);
+        return false;
+    }
+    const Real scale = totalEnergy / _autocorrelation[0];
+
+    // cumulative mean normalized difference, PitchYin's window length
+    const auto windowLength = static_cast<Real>(n / 2 + 1);
+    difference[0] = 1.f;
+    Real runningSum {0.f};
+    for (size_t tau = 1; tau < difference.size(); ++tau) {
+        const Real shared = static_cast<Real>(n - tau);
+        Real d = _energy[n - tau] + (totalEnergy - _energy[tau]) - 2.f * scale * _autocorrelation[tau];
+        d = std::max(d, 0.f) * windowLength / shared;
+        runningSum += d;
+        difference[tau] = runningSum > 0.f ? d * static_cast<Real>(tau) / runningSum : 1.f;
+    }
+    return true;
+}
+
+auto FastYin::estimate(const std::span<const Real> difference) const -> Estimate
+{
+    // the first dip below the tolerance, followed to the bottom of its valley; else the lowest point
+    const auto tauMin = static_cast<size_t>(_tauMin);
+    const auto tauMax = static_cast<size_t>(_tauMax);
+    size_t period = 0;
+    for (size_t tau = tauMin; tau < tauMax; ++tau) {
+        if (difference[tau] < _tolerance) {
+            while (tau + 1 < tauMax && difference[tau + 1] < difference[tau]) {
+                ++tau;
+            }
+            period = tau;
+            break;
+        }
+    }
+    if (period == 0) {
+        period = static_cast<size_t>(std::distance(difference.begin(),
+            std::min_element(difference.begin() + static_cast<std::ptrdiff_t>(tauMin),
+                             difference.begin() + static_cast<std::ptrdiff_t>(tauMax))));
+    }
+
+    auto lag = static_cast<Real>(period);
+    Real minimum = difference[period];
+    if (_interpolate && period > 0 && period + 1 < difference.size()) {
+        const Real left = difference[period - 1], right = difference[period + 1];
+        if (const Real curvature = left - 2.f * minimum + right; curvature > 0.f) {
+            const Real offset = 0.5f * (left - right) / curvature;
+            lag += offset;
+            minimum -= 0.25f * (left - right) * offset;
+        }
+    }
+    return {
+        .frequency = lag > 0.f ? _sampleRate / lag : 0.f,
+        .confidence = std::clamp(1.f - minimum, 0.f, 1.f)
+    };
+}
+
+}   // namespace nvs::analysis
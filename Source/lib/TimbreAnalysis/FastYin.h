@@ -0,0 +1,66 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <complex>
+#include <memory>
+#include <span>
+
+#include "AnalysisUsing.h"
+#include "../Settings.h"
+
+namespace nvs::analysis {
+
+/**
+ * YIN pitch detection (de Cheveigné & Kawahara, 2002) with the difference function taken from an FFT autocorrelation,
+ * in O(N log N) per frame instead of PitchYin's O(N²).
+ * The autocorrelation is the inverse transform of the frame's power spectrum, which the timbre path computes anyway:
+ * the pipeline's windowed frames are zero-padded to twice frameSize, so their spectrum gives the linear (unaliased)
+ * autocorrelation at every lag. d(τ) = Σ(x_j - x_{j+τ})² then follows from the autocorrelation and running energies.
+ *
+ * That difference runs over the N - τ samples both copies of the frame share, where PitchYin's runs over a fixed
+ * N / 2 + 1; it is rescaled to that length. Lag range, tolerance, threshold search and parabolic interpolation follow
+ * PitchYin's, so the two agree closely but not exactly.
+ */
+class FastYin {
+public:
+    // uses frameSize, sampleRate, the pitch settings, and bfcc.spectrumType to know what the spectrum holds
+    explicit FastYin(AnalyzerSettings const &settings);
+    ~FastYin();
+
+    struct Estimate {
+        Real frequency {0.f};   // Hz; 0 if no period was found
+        Real confidence {0.f};  // 1 - the normalized difference at the period, as PitchYin's pitchConfidence
+    };
+
+    // windowedFrame: frameSize samples, possibly followed by the zero padding
+    // spectrum: the (power or magnitude) spectrum of windowedFrame zero-padded to 2 * frameSize, frameSize + 1 bins
+    Estimate compute(std::span<const Real> windowedFrame, std::span<const Real> spectrum);
+
+    // the two halves of compute, for callers that pick periods differently (ProbabilisticYin).
+    // writes the cumulative mean normalized difference for lags [0, getDifferenceLength()) into difference;
+    // false (and all ones) for a silent frame
+    bool computeDifference(std::span<const Real> windowedFrame, std::span<const Real> spectrum, std::span<Real> difference);
+    Estimate estimate(std::span<const Real> difference) const;
+
+    size_t getDifferenceLength() const { return static_cast<size_t>(_tauMax) + 2; }
+    // periods are searched in [getTauMin(), getTauMax())
+    int getTauMin() const { return _tauMin; }
+    int getTauMax() const { return _tauMax; }
+    Real getSampleRate() const { return _sampleRate; }
+
+private:
+    const int _frameSize;
+    const Real _sampleRate;
+    const int _tauMin, _tauMax;
+    const Real _tolerance;
+    const bool _interpolate;
+    const bool _spectrumIsPower;
+
+    std::unique_ptr<standard::Algorithm> _ifft;
+    std::vector<std::complex<Real>> _powerSpectrum;
+    vecReal _autocorrelation, _energy, _difference;
+};
+
+}   // namespace nvs::analysis
@@ -0,0 +1,264 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "ProbabilisticYin.h"
+#include <iostream>
+#include <limits>
+
+namespace nvs::analysis {
+
+namespace {
+constexpr size_t numThresholds {100};
+constexpr Real betaAlpha {2.f}, betaBeta {18.f};   // mean threshold 0.1, as pYin's default
+constexpr Real absoluteMinimumWeight {0.01f};       // for the lowest point, when a threshold finds no dip
+constexpr Real minimumLogArgument {1e-30f};
+
+Real frequencyToMidi(const Real f) {
+    return 69.f + 12.f * std::log2(f / 440.f);
+}
+Real logOf(const Real p) {
+    return std::log(std::max(p, minimumLogArgument));
+}
+// pitch bins from minFrequency up to maxFrequency; a single bin if the range is empty, which settings reject anyway
+size_t getNumPitchBins(AnalyzerSettings const &settings, const int binsPerSemitone) {
+    const auto minFrequency = static_cast<Real>(settings.pitch.minFrequency);
+    const auto maxFrequency = static_cast<Real>(settings.pitch.maxFrequency);
+    if (!(0.f < minFrequency && minFrequency < maxFrequency)) {
+        std::cerr << "ProbabilisticYin: pitch range " << minFrequency << " .. " << maxFrequency << " Hz is empty\n";
+        jassertfalse;
+        return 1;
+    }
+    return static_cast<size_t>(std::floor((frequencyToMidi(maxFrequency) - frequencyToMidi(minFrequency))
+                                          * static_cast<Real>(binsPerSemitone))) + 1;
+}
+}   // anonymous namespace
+
+ProbabilisticYin::ProbabilisticYin(AnalyzerSettings const &settings)
+:   _yin(settings)
+,   _minMidi(frequencyToMidi(static_cast<Real>(settings.pitch.minFrequency)))
+,   _numBins(getNumPitchBins(settings, binsPerSemitone))
+,   _maxJump(maxJumpSemitones * binsPerSemitone)
+,   _differences(_yin.getDifferenceLength())
+,   _voicedObservations(_numBins)
+,   _candidateFrequencies(_numBins)
+,   _backpointers(2 * _numBins)
+{
+    jassert (_numBins < std::numeric_limits<juce::uint16>::max() / 2);
+
+    Real weightSum {0.f};
+    for (size_t i = 0; i < numThresholds; ++i) {
+        const Real t = static_cast<Real>(i + 1) / static_cast<Real>(numThresholds);
+        _thresholds.push_back(t);
+        _thresholdWeights.push_back(std::pow(t, betaAlpha - 1.f) * std::pow(1.f - t, betaBeta - 1.f));
+        weightSum += _thresholdWeights.back();
+    }
+    for (auto &w : _thresholdWeights) {
+        w /= weightSum;
+    }
+
+    // triangular, over jumps of at most _maxJump bins
+    Real jumpSum {0.f};
+    for (int d = -_maxJump; d <= _maxJump; ++d) {
+        jumpSum += static_cast<Real>(_maxJump + 1 - std::abs(d));
+    }
+    for (int d = -_maxJump; d <= _maxJump; ++d) {
+        _logJumpWeights.push_back(std::log(static_cast<Real>(_maxJump + 1 - std::abs(d)) / jumpSum));
+    }
+    _firstDips.resize(numThresholds);
+    _previous.resize(2 * _numBins);
+    _current.resize(2 * _numBins);
+}
+
+void ProbabilisticYin::beginEvent() {
+    _differences.clearRows();
+    _silent.clear();
+}
+
+void ProbabilisticYin::pushFrame(const std::span<const Real> windowedFrame, const std::span<const Real> spectrum) {
+    const bool voiced = _yin.computeDifference(windowedFrame, spectrum, _differences.appendRow());
+    _silent.push_back(voiced ? 0 : 1);
+}
+
+void ProbabilisticYin::endEvent(vecReal &frequencies, vecReal &voicedProbabilities) {
+    extractCandidates();
+    decode(frequencies);
+    voicedProbabilities.assign(_voicedMass.begin(), _voicedMass.end());
+}
+
+Real ProbabilisticYin::getBinFrequency(const size_t bin) const {
+    const Real midi = _minMidi + static_cast<Real>(bin) / static_cast<Real>(binsPerSemitone);
+    return 440.f * std::exp2((midi - 69.f) / 12.f);
+}
+
+void ProbabilisticYin::extractCandidates() {
+    const size_t numFrames = _differences.numRows();
+    const auto tauMin = static_cast<size_t>(_yin.getTauMin());
+    const auto tauMax = static_cast<size_t>(_yin.getTauMax());
+    _voicedObservations.clearRows();
+    _candidateFrequencies.clearRows();
+    _unvoicedObservations.clear();
+    _voicedMass.clear();
+
+    for (size_t frame = 0; frame < numFrames; ++frame) {
+        const auto observations = _voicedObservations.appendRow();
+        const auto candidateFrequencies = _candidateFrequencies.appendRow();
+        Real mass {0.f};
+
+        if (!_silent[frame]) {
+            const auto difference = _differences.rowSpan(frame);
+
+            // each threshold's first dip, in one sweep: the first lag below a threshold is where the running minimum
+            // first falls below it, so as the minimum falls it claims the thresholds above it, highest first
+            std::fill(_firstDips.begin(), _firstDips.end(), 0);
+            size_t unclaimed = numThresholds;
+            Real runningMinimum = std::numeric_limits<Real>::max();
+            size_t lowestLag = tauMin;
+            for (size_t tau = tauMin; tau < tauMax && unclaimed > 0; ++tau) {
+                if (difference[tau] < runningMinimum) {
+                    runningMinimum = difference[tau];
+                    lowestLag = tau;
+                    while (unclaimed > 0 && _thresholds[unclaimed - 1] > runningMinimum) {
+                        _firstDips[--unclaimed] = tau;
+                    }
+                }
+            }
+            if (unclaimed > 0) {
+                lowestLag = static_cast<size_t>(std::distance(difference.begin(),
+                    std::min_element(difference.begin() + static_cast<std::ptrdiff_t>(tauMin),
+                                     difference.begin() + static_cast<std::ptrdiff_t>(tauMax))));
+            }
+
+            // thresholds sharing a dip are one candidate, at the bottom of its valley
+            const auto addCandidate = [&](const size_t dip, const Real probability) {
+                if (probability <= 0.f) {
+                    return;
+                }
+                size_t tau = dip;
+                while (tau + 1 < tauMax && difference[tau + 1] < difference[tau]) {
+                    ++tau;
+                }
+                auto lag = static_cast<Real>(tau);
+                const Real left = difference[tau - 1], centre = difference[tau], right = difference[tau + 1];
+                if (const Real curvature = left - 2.f * centre + right; curvature > 0.f) {
+                    lag += 0.5f * (left - right) / curvature;
+                }
+                const Real frequency = _yin.getSampleRate() / lag;
+                const auto bin = std::lround((frequencyToMidi(frequency) - _minMidi) * binsPerSemitone);
+                if (bin < 0 || static_cast<size_t>(bin) >= _numBins) {
+                    return;
+                }
+                auto &observation = observations[static_cast<size_t>(bin)];
+                if (probability * yinTrust > observation) {     // the bin's most probable candidate gives its frequency
+                    candidateFrequencies[static_cast<size_t>(bin)] = frequency;
+                }
+                observation += probability * yinTrust;
+                mass += probability;
+            };
+            size_t groupDip {0};
+            Real groupProbability {0.f};
+            for (size_t i = 0; i < numThresholds; ++i) {
+                const size_t dip = _firstDips[i] != 0 ? _firstDips[i] : lowestLag;
+                const Real probability = _thresholdWeights[i] * (_firstDips[i] != 0 ? 1.f : absoluteMinimumWeight);
+                if (dip != groupDip) {
+                    addCandidate(groupDip, groupProbability);
+                    groupDip = dip;
+                    groupProbability = 0.f;
+                }
+                groupProbability += probability;
+            }
+            addCandidate(groupDip, groupProbability);
+        }
+        mass = std::min(mass, 1.f);
+        _voicedMass.push_back(mass);
+        _unvoicedObservations.push_back((1.f - yinTrust * mass) / static_cast<Real>(_numBins));
+    }
+}
+
+void ProbabilisticYin::decode(vecReal &frequencies) {
+    const size_t numFrames = _voicedObservations.numRows();
+    frequencies.assign(numFrames, 0.f);
+    if (numFrames == 0) {
+        return;
+    }
+    const size_t n = _numBins;
+    const auto jump = static_cast<size_t>(_maxJump);
+    const Real logStay = std::log(voicingStayProbability);
+    const Real logSwitch = std::log(1.f - voicingStayProbability);
+    const Real logInitial = logOf(0.5f / static_cast<Real>(n));
+
+    // states [0, n) are voiced pitch bins, [n, 2n) the same bins unvoiced
+    {
+        const auto observations = _voicedObservations.rowSpan(0);
+        const Real unvoiced = logOf(_unvoicedObservations[0]);
+        for (size_t b = 0; b < n; ++b) {
+            _previous[b] = logInitial + logOf(observations[b]);
+            _previous[n + b] = logInitial + unvoiced;
+        }
+    }
+    _backpointers.clearRows();
+    _backpointers.reserveRows(numFrames - 1);
+    for (size_t frame = 1; frame < numFrames; ++frame) {
+        const auto observations = _voicedObservations.rowSpan(frame);
+        const Real unvoiced = logOf(_unvoicedObservations[frame]);
+        const auto back = _backpointers.appendRow();
+        const Real *previousVoiced = _previous.data();
+        const Real *previousUnvoiced = _previous.data() + n;
+
+        for (size_t b = 0; b < n; ++b) {
+            // the best predecessor of each voicing, within jump bins
+            const size_t lo = b > jump ? b - jump : 0;
+            const size_t hi = std::min(b + jump, n - 1);
+            const Real *weights = _logJumpWeights.data() + (jump + lo - b);
+            Real bestVoiced = -std::numeric_limits<Real>::infinity(), bestUnvoiced = bestVoiced;
+            size_t fromVoiced = lo, fromUnvoiced = lo;
+            for (size_t i = lo; i <= hi; ++i) {
+                const Real w = weights[i - lo];
+                if (const Real v = previousVoiced[i] + w; v > bestVoiced) {
+                    bestVoiced = v;
+                    fromVoiced = i;
+                }
+                if (const Real u = previousUnvoiced[i] + w; u > bestUnvoiced) {
+                    bestUnvoiced = u;
+                    fromUnvoiced = i;
+                }
+            }
+            if (bestVoiced + logStay >= bestUnvoiced + logSwitch) {
+                _current[b] = bestVoiced + logStay;
+                back[b] = static_cast<juce::uint16>(fromVoiced);
+            } else {
+                _current[b] = bestUnvoiced + logSwitch;
+                back[b] = static_cast<juce::uint16>(n + fromUnvoiced);
+            }
+            _current[b] += logOf(observations[b]);
+
+            if (bestUnvoiced + logStay >= bestVoiced + logSwitch) {
+                _current[n + b] = bestUnvoiced + logStay;
+                back[n + b] = static_cast<juce::uint16>(n + fromUnvoiced);
+            } else {
+                _current[n + b] = bestVoiced + logSwitch;
+                back[n + b] = static_cast<juce::uint16>(fromVoiced);
+            }
+            _current[n + b] += unvoiced;
+        }
+        // keep the scores near zero over long events
+        const Real best = *std::max_element(_current.begin(), _current.end());
+        for (auto &score : _current) {
+            score -= best;
+        }
+        std::swap(_previous, _current);
+    }
+
+    auto state = static_cast<size_t>(std::distance(_previous.begin(), std::max_element(_previous.begin(), _previous.end())));
+    for (size_t frame = numFrames; frame-- > 0;) {
+        if (state < n) {
+            const Real candidate = _candidateFrequencies(frame, state);
+            frequencies[frame] = candidate > 0.f ? candidate : getBinFrequency(state);
+        }
+        if (frame > 0) {
+            state = _backpointers(frame - 1, state);
+        }
+    }
+}
+
+}   // namespace nvs::analysis
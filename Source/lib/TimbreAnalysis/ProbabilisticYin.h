@@ -0,0 +1,69 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <span>
+
+#include "AnalysisUsing.h"
+#include "../FeatureMatrix.h"
+#include "../Settings.h"
+#include "FastYin.h"
+
+namespace nvs::analysis {
+
+/**
+ * pYin (Mauch & Dixon, 2014): YIN's period search repeated over a distribution of thresholds gives each frame a set of
+ * pitch candidates with probabilities, and a hidden Markov model over (pitch bin, voiced/unvoiced) states picks the
+ * smoothest likely path through an event's frames.
+ *
+ * Frames are pushed one at a time, but only their difference functions (from FastYin, on the shared spectrum) are
+ * kept; candidates are extracted for all of the event's frames in one pass when it ends, and decoded with a Viterbi
+ * whose per-frame state fits in L1: the pitch transitions are banded (at most maxJumpSemitones per frame), so each
+ * state looks back at a short contiguous run of the previous frame's scores, with backpointers kept as 16-bit indices.
+ */
+class ProbabilisticYin {
+public:
+    // uses frameSize, sampleRate, pitch.minFrequency/maxFrequency, and bfcc.spectrumType to know what the spectrum holds
+    explicit ProbabilisticYin(AnalyzerSettings const &settings);
+
+    void beginEvent();
+    // as FastYin::compute
+    void pushFrame(std::span<const Real> windowedFrame, std::span<const Real> spectrum);
+    // decodes the frames pushed since beginEvent: frequencies in Hz (0 where unvoiced), and each frame's voiced
+    // probability (the candidates' total probability)
+    void endEvent(vecReal &frequencies, vecReal &voicedProbabilities);
+
+    size_t getNumPitchBins() const { return _numBins; }
+
+private:
+    static constexpr int binsPerSemitone {5};
+    static constexpr int maxJumpSemitones {2};
+    static constexpr Real yinTrust {0.5f};          // how far the candidates' probabilities are believed
+    static constexpr Real voicingStayProbability {0.99f};
+
+    FastYin _yin;
+    const Real _minMidi;
+    const size_t _numBins;
+    const int _maxJump;
+
+    vecReal _thresholds, _thresholdWeights;     // ascending thresholds and their beta(2, 18) probabilities
+    vecReal _logJumpWeights;                    // by bin jump + _maxJump
+
+    // per event: one row per frame
+    FeatureMatrix<Real> _differences;
+    std::vector<char> _silent;
+    FeatureMatrix<Real> _voicedObservations, _candidateFrequencies;     // by pitch bin
+    vecReal _unvoicedObservations, _voicedMass;
+    FeatureMatrix<juce::uint16> _backpointers;                          // by state: voiced bins, then unvoiced
+
+    // scratch
+    std::vector<size_t> _firstDips;
+    vecReal _previous, _current;
+
+    void extractCandidates();
+    void decode(vecReal &frequencies);
+    Real getBinFrequency(size_t bin) const;
+};
+
+}   // namespace nvs::analysis
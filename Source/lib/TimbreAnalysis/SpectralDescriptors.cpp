@@ -0,0 +1,182 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#include "SpectralDescriptors.h"
+#include <array>
+#include <cmath>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace nvs::analysis {
+
+namespace {
+
+using FVO = juce::FloatVectorOperations;
+constexpr size_t lanes {8};
+
+Real &column(std::span<Real> timbreFrame, const Feature_e f) {
+    return timbreFrame[static_cast<size_t>(f)];
+}
+
+}   // anonymous namespace
+
+SpectralDescriptors::SpectralDescriptors(AnalyzerSettings const &settings, const size_t spectrumSize)
+:   _size(spectrumSize)
+,   _range(static_cast<Real>(settings.analysis.sampleRate) * 0.5f)
+,   _magnitudeThreshold(static_cast<Real>(settings.spectralComplexity.magnitudeThreshold))
+{
+    jassert (_size > 1);
+    auto const &request = settings.request;
+    for (auto [wanted, f] : { std::pair { &_centroid, Feature_e::SpectralCentroid },
+                              std::pair { &_decrease, Feature_e::SpectralDecrease },
+                              std::pair { &_flatness, Feature_e::SpectralFlatness },
+                              std::pair { &_crest, Feature_e::SpectralCrest },
+                              std::pair { &_complexity, Feature_e::SpectralComplexity },
+                              std::pair { &_strongPeak, Feature_e::StrongPeak } })
+    {
+        *wanted = request.wants(f);
+        _numRequested += *wanted ? 1 : 0;
+    }
+
+    // Decrease is the slope of the spectrum against bin frequency. the frequencies are fixed, so they are centred
+    // once and the slope is one dot product: Σ (f_k - mean f) x_k / Σ (f_k - mean f)²
+    _centeredFrequencies.resize(_size);
+    const Real binHz = _range / static_cast<Real>(_size - 1);
+    for (size_t k = 0; k < _size; ++k) {
+        _centeredFrequencies[k] = static_cast<Real>(k) * binHz - 0.5f * _range;
+        _frequencyVariance += _centeredFrequencies[k] * _centeredFrequencies[k];
+    }
+}
+
+void SpectralDescriptors::compute(const std::span<const Real> spectrum, const std::span<Real> timbreFrame) const
+{
+    jassert (spectrum.size() == _size);
+    jassert (timbreFrame.size() >= static_cast<size_t>(Feature_e::StrongPeak) + 1);
+    if (_numRequested == 0) {
+        return;
+    }
+
+    // the reductions, as independent partial sums so the loop vectorizes without reassociation flags
+    std::array<Real, lanes> sums {}, indexSums {}, slopeSums {};
+    const Real *x = spectrum.data();
+    const Real *centred = _centeredFrequencies.data();
+    size_t k {0};
+    for (; k + lanes <= _size; k += lanes) {
+        for (size_t l = 0; l < lanes; ++l) {
+            sums[l] += x[k + l];
+            indexSums[l] += static_cast<Real>(k + l) * x[k + l];
+            slopeSums[l] += centred[k + l] * x[k + l];
+        }
+    }
+    Real sum {0.f}, indexSum {0.f}, slopeSum {0.f};
+    for (; k < _size; ++k) {
+        sum += x[k];
+        indexSum += static_cast<Real>(k) * x[k];
+        slopeSum += centred[k] * x[k];
+    }
+    for (size_t l = 0; l < lanes; ++l) {
+        sum += sums[l];
+        indexSum += indexSums[l];
+        slopeSum += slopeSums[l];
+    }
+    const auto range = FVO::findMinAndMax(x, static_cast<int>(_size));
+    const Real mean = sum / static_cast<Real>(_size);
+
+    if (_centroid) {
+        column(timbreFrame, Feature_e::SpectralCentroid) =
+            sum != 0.f ? indexSum / sum * _range / static_cast<Real>(_size - 1) : 0.f;
+    }
+    if (_decrease) {
+        column(timbreFrame, Feature_e::SpectralDecrease) = slopeSum / _frequencyVariance;
+    }
+    if (_flatness) {
+        column(timbreFrame, Feature_e::SpectralFlatness) = flatnessDB(spectrum, range.getStart(), sum);
+    }
+    if (_crest) {
+        column(timbreFrame, Feature_e::SpectralCrest) = mean != 0.f ? range.getEnd() / mean : 0.f;
+    }
+    if (_complexity) {
+        column(timbreFrame, Feature_e::SpectralComplexity) = countPeaks(spectrum);
+    }
+    if (_strongPeak) {
+        const auto maxIndex = static_cast<size_t>(std::distance(x, std::find(x, x + _size, range.getEnd())));
+        column(timbreFrame, Feature_e::StrongPeak) = strongPeak(spectrum, maxIndex);
+    }
+}
+
+// FlatnessDB: the geometric over the arithmetic mean in dB, scaled so -60 dB (or a zero bin) is 1
+Real SpectralDescriptors::flatnessDB(const std::span<const Real> spectrum, const Real minimum, const Real sum)
+{
+    if (minimum <= 0.f || sum <= 0.f) {
+        return 1.f;
+    }
+    // Σ log x, one log per four bins: a product of four floats always fits in a double
+    double logSum {0.0};
+    size_t k {0};
+    for (; k + 4 <= spectrum.size(); k += 4) {
+        logSum += std::log(static_cast<double>(spectrum[k]) * static_cast<double>(spectrum[k + 1])
+                           * static_cast<double>(spectrum[k + 2]) * static_cast<double>(spectrum[k + 3]));
+    }
+    for (; k < spectrum.size(); ++k) {
+        logSum += std::log(static_cast<double>(spectrum[k]));
+    }
+    const auto n = static_cast<double>(spectrum.size());
+    const double flatness = std::exp(logSum / n) / (static_cast<double>(sum) / n);
+    if (flatness <= 0.0) {
+        return 1.f;
+    }
+    return static_cast<Real>(std::min(10.0 * std::log10(flatness) / -60.0, 1.0));
+}
+
+// SpectralComplexity: the spectral peaks above magnitudeThreshold, at most maxPeaks. a peak is a bin above both
+// neighbours (the ends need only beat their one neighbour); a plateau counts once if it falls on its far side
+Real SpectralDescriptors::countPeaks(const std::span<const Real> spectrum) const
+{
+    const Real *x = spectrum.data();
+    const size_t last = _size - 1;
+    size_t count {0};
+    if (x[0] > _magnitudeThreshold && x[0] > x[1]) {
+        ++count;
+    }
+    for (size_t k = 1; k < last; ++k) {
+        if (x[k] <= _magnitudeThreshold || x[k] <= x[k - 1] || x[k] < x[k + 1]) {
+            continue;
+        }
+        if (x[k] == x[k + 1]) {
+            size_t end = k + 1;
+            while (end < last && x[end + 1] == x[k]) {
+                ++end;
+            }
+            if (end < last && x[end + 1] > x[k]) {
+                k = end;
+                continue;   // a step up, not a peak
+            }
+            k = end;
+        }
+        ++count;
+    }
+    if (x[last] > _magnitudeThreshold && x[last] > x[last - 1]) {
+        ++count;
+    }
+    return static_cast<Real>(std::min(count, maxPeaks));
+}
+
+// StrongPeak: the maximum over the log10 bandwidth (in bins) of the run of bins above half of it
+Real SpectralDescriptors::strongPeak(const std::span<const Real> spectrum, const size_t maxIndex)
+{
+    const Real maximum = spectrum[maxIndex];
+    if (maximum <= 0.f) {
+        return 0.f;
+    }
+    const Real threshold = 0.5f * maximum;
+    size_t left = maxIndex, right = maxIndex + 1;
+    while (left > 0 && spectrum[left - 1] > threshold) {
+        --left;
+    }
+    while (right < spectrum.size() && spectrum[right] > threshold) {
+        ++right;
+    }
+    return maximum / std::log10(static_cast<Real>(right + 1) / static_cast<Real>(left + 1));
+}
+
+} // namespace nvs::analysis
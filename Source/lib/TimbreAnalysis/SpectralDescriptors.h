@@ -0,0 +1,50 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+#pragma once
+#include <span>
+
+#include "AnalysisUsing.h"
+#include "../Settings.h"
+#include "../Features.h"
+
+namespace nvs::analysis {
+
+/**
+ * The spectral descriptors of a timbre frame (SpectralCentroid .. StrongPeak), computed together in place of
+ * Centroid, Decrease, FlatnessDB, Crest, SpectralComplexity and StrongPeak each scanning the spectrum on their own.
+ *
+ * One pass gathers everything that reduces over the whole spectrum (sum, index-weighted sum, the regression sum
+ * Decrease needs, minimum and maximum) into independent partial sums that vectorize; flatness takes its geometric
+ * mean over a second pass only when requested, with one log per four bins. The peak count and the strong peak's
+ * bandwidth follow, as short comparison passes. Results match the Essentia algorithms as configured in
+ * EventFramePipeline (check with --benchmark spectralDescriptors).
+ */
+class SpectralDescriptors {
+public:
+    // uses sampleRate, spectralComplexity.magnitudeThreshold and the descriptors settings.request asks for
+    SpectralDescriptors(AnalyzerSettings const &settings, size_t spectrumSize);
+
+    bool describesAny() const { return _numRequested > 0; }
+
+    // writes the requested descriptors of spectrum into their Feature_e columns of timbreFrame; the others are untouched
+    void compute(std::span<const Real> spectrum, std::span<Real> timbreFrame) const;
+
+private:
+    static constexpr size_t maxPeaks {100};     // as SpectralComplexity configures its SpectralPeaks
+
+    bool _centroid, _decrease, _flatness, _crest, _complexity, _strongPeak;
+    int _numRequested {0};
+    const size_t _size;
+    const Real _range;                  // Centroid's and Decrease's: half the sample rate
+    const Real _magnitudeThreshold;
+    vecReal _centeredFrequencies;       // bin frequencies minus their mean, for Decrease's regression
+    Real _frequencyVariance {0.f};      // their sum of squares
+
+    Real countPeaks(std::span<const Real> spectrum) const;
+    static Real strongPeak(std::span<const Real> spectrum, size_t maxIndex);
+    static Real flatnessDB(std::span<const Real> spectrum, Real minimum, Real sum);
+};
+
+} // namespace nvs::analysis
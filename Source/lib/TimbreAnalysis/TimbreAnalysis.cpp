@@ -9,6 +9,12 @@
 */
 
 #include "TimbreAnalysis.h"
+#include "FastYin.h"
+#include "ProbabilisticYin.h"
+#include "ChromaPitch.h"
+#include "SpectralDescriptors.h"
+#include "BatchBFCC.h"
+#include "../SpectralFrontEnd.h"
 
 namespace nvs::analysis {
 
@@ -36,11 +42,11 @@ PitchesAndConfidences calculatePitchesEssentiaYin(std::span<Real> waveSpan, Anal
                 "zeroPhase",   false
             ));
 
-    std::map<std::string, std::string> pitchAlgoNicknameMap {
+    static const std::map<std::string, std::string> pitchAlgoNicknameMap {
             {"yin", "PitchYin"}
     };	// for now we only handle this
 
-    auto pitchDet = std::unique_ptr<standard::Algorithm>(standardFactory::create (pitchAlgoNicknameMap[settings.pitch.pitchDetectionAlgorithm.toStdString()],
+    auto pitchDet = std::unique_ptr<standard::Algorithm>(standardFactory::create (pitchAlgoNicknameMap.at(settings.pitch.pitchDetectionAlgorithm.toStdString()),
                 "frameSize",   frameSize,
                 "interpolate",  settings.pitch.interpolate,
                 "maxFrequency", settings.pitch.maxFrequency,
@@ -96,6 +102,92 @@ PitchesAndConfidences calculatePitchesEssentiaYin(std::span<Real> waveSpan, Anal
         return PitchesAndConfidences{pitches, confidences};
     }
 }
+
+// the spectrum BFCC is configured for
+SpectralFrontEnd::Output spectrumOutput(AnalyzerSettings const& settings) {
+    return settings.bfcc.spectrumType == "power" ? SpectralFrontEnd::Output::Power : SpectralFrontEnd::Output::Magnitude;
+}
+
+Real frequencyToMidi(const Real frequency) {
+    return frequency == 0.f ? 0.f : 69.f + 12.f * std::log2(frequency / 440.f);
+}
+
+// frames the wave as calculatePitchesEssentiaYin does, handing each windowed frame and its spectrum (of the frame
+// zero-padded to twice its size, as the timbre path computes it) to onFrame
+template <typename OnFrame>
+void forEachSpectralFrame(std::span<Real> waveSpan, AnalyzerSettings const& settings, OnFrame &&onFrame){
+    vecReal wave(waveSpan.begin(), waveSpan.end());
+
+    int const frameSize = settings.analysis.frameSize;
+
+    auto frameCutter = std::unique_ptr<standard::Algorithm>(standardFactory::create ("FrameCutter",
+                "frameSize",            frameSize,
+                "hopSize",              settings.analysis.hopSize,
+                "lastFrameToEndOfFile", true,
+                "startFromZero",        true,
+                "validFrameThresholdRatio", 0.f
+            ));
+    auto windowing = std::unique_ptr<standard::Algorithm>(standardFactory::create ("Windowing",
+                "normalized", false,
+                "size",        frameSize,
+                "zeroPadding", frameSize,
+                "type",        settings.analysis.windowingType.toStdString(),
+                "zeroPhase",   false
+            ));
+    SpectralFrontEnd frontEnd(frameSize * 2, spectrumOutput(settings));
+
+    vecReal frame, windowedFrame, spectrumVec(frontEnd.getNumColumns());
+    while (true) {
+        frameCutter->input("signal").set(wave);
+        frameCutter->output("frame").set(frame);
+        frameCutter->compute();
+        if (frame.empty()) break;
+
+        windowing->input("frame").set(frame);
+        windowing->output("frame").set(windowedFrame);
+        windowing->compute();
+
+        frontEnd.compute(windowedFrame, spectrumVec);
+
+        onFrame(windowedFrame, spectrumVec);
+    }
+}
+
+// as calculatePitchesEssentiaYin, with FastYin on each windowed frame's spectrum
+PitchesAndConfidences calculatePitchesFastYin(std::span<Real> waveSpan, AnalyzerSettings const& settings){
+    FastYin yin(settings);
+    PitchesAndConfidences result;
+    forEachSpectralFrame(waveSpan, settings, [&](vecReal const &windowedFrame, vecReal const &spectrum) {
+        const auto [frequency, confidence] = yin.compute(windowedFrame, spectrum);
+        result.pitches.push_back(frequencyToMidi(frequency));
+        result.confidences.push_back(confidence);
+    });
+    return result;
+}
+
+// the wave decoded as one pYin event; confidences are the frames' voiced probabilities, pitches 0 where unvoiced
+PitchesAndConfidences calculatePitchesPYin(std::span<Real> waveSpan, AnalyzerSettings const& settings){
+    ProbabilisticYin yin(settings);
+    yin.beginEvent();
+    forEachSpectralFrame(waveSpan, settings, [&yin](vecReal const &windowedFrame, vecReal const &spectrum) {
+        yin.pushFrame(windowedFrame, spectrum);
+    });
+    PitchesAndConfidences result;
+    yin.endEvent(result.pitches, result.confidences);
+    std::ranges::transform(result.pitches, result.pitches.begin(), frequencyToMidi);
+    return result;
+}
+
+PitchesAndConfidences calculatePitchesChroma(std::span<Real> waveSpan, AnalyzerSettings const& settings){
+    ChromaPitch chroma(settings);
+    PitchesAndConfidences result;
+    forEachSpectralFrame(waveSpan, settings, [&](vecReal const &, vecReal const &spectrum) {
+        const auto [frequency, confidence] = chroma.compute(spectrum);
+        result.pitches.push_back(frequencyToMidi(frequency));
+        result.confidences.push_back(confidence);
+    });
+    return result;
+}
 }	// anonymous namespace
 
 PitchesAndConfidences calculatePitchesAndConfidences (vecReal waveEvent,
@@ -106,15 +198,14 @@ PitchesAndConfidences calculatePitchesAndConfidences (vecReal waveEvent,
     if (algo == "yin") {
         return calculatePitchesEssentiaYin (waveEvent, settings);
     }
+    if (algo == "yinFast") {
+        return calculatePitchesFastYin (waveEvent, settings);
+    }
     if (algo == "pYin") {
-        jassertfalse;  // not implemented
-        return {};
-        //		return calculatePitchesEssentiaPYin (waveEvent, factory, settingsTree);
+        return calculatePitchesPYin (waveEvent, settings);
     }
     if (algo == "chroma") {
-        jassertfalse;  // not implemented
-        return {};
-        //		return calculatePitchesEssentiaChroma (waveEvent, factory, settingsTree);
+        return calculatePitchesChroma (waveEvent, settings);
     }
     jassertfalse;  // unknown algorithm
     return {};
@@ -198,7 +289,7 @@ vecReal calculateLoudnesses(const std::span<Real const> waveSpan, AnalyzerSettin
     return loudnesses;
 }
 
-FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings)
+TimbreFrames calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings)
 {
     vecReal wave(waveSpan.begin(), waveSpan.end());
 
@@ -226,146 +317,71 @@ FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, Analy
           "type",        settings.analysis.windowingType.toStdString(),
           "zeroPhase",   false
     ));
-    auto const spectrumTypeStr = settings.bfcc.spectrumType.toStdString();
-    bool const isPower = (spectrumTypeStr == "power");
-    std::string const specAlgoStr = isPower ? "PowerSpectrum" : "Spectrum";
-    const auto spectrum = std::unique_ptr<standard::Algorithm>(standardFactory::create (
-            specAlgoStr,
-            "size", frameSize * 2
-            ));
-    std::map<juce::String, int> dctTypeStringToInt {
-            { "typeII",  2 },
-            { "typeIII", 3 }
-    };
-    std::map<std::string, std::string> logTypeMap {
-            {"PowerSpectrum", "dbpow"},
-            {"Spectrum", "dbamp"}
-    };
-    const auto sampleRate  = static_cast<float>(settings.analysis.sampleRate);
-    const auto bfcc = std::unique_ptr<standard::Algorithm>(standardFactory::create (
-    "BFCC",
-    "dctType",             dctTypeStringToInt.at(settings.bfcc.dctType.toStdString()),
-    "highFrequencyBound",  settings.bfcc.highFrequencyBound,
-    "inputSize",           frameSize + 1,
-    "liftering",           settings.bfcc.liftering,
-    "logType",             logTypeMap.at(specAlgoStr),
-
-    "lowFrequencyBound",   settings.bfcc.lowFrequencyBound,
-    "normalize",           settings.bfcc.normalize.toStdString(),
-    "numberBands",         settings.bfcc.numBands,
-    "numberCoefficients",  settings.bfcc.numCoefficients,
-    "sampleRate",          sampleRate,
-    "type",                spectrumTypeStr,
-    "weighting",           settings.bfcc.weightingType.toStdString()
-    ));
-    const auto centroid_a = std::unique_ptr<standard::Algorithm>(standardFactory::create ("Centroid",
-        "range", sampleRate * 0.5));
-    const auto decrease_a = std::unique_ptr<standard::Algorithm>(standardFactory::create ("Decrease",
-        "range", sampleRate * 0.5));
-    const auto flatnessDB_a = std::unique_ptr<standard::Algorithm>(standardFactory::create ("FlatnessDB"));
-    const auto crest_a = std::unique_ptr<standard::Algorithm>(standardFactory::create ("Crest"));
-    const auto spectralComplexity_a = std::unique_ptr<standard::Algorithm>(standardFactory::create ("SpectralComplexity",
-        "magnitudeThreshold", settings.spectralComplexity.magnitudeThreshold));
-    const auto strongPeakinesses_a = std::unique_ptr<standard::Algorithm>(standardFactory::create("StrongPeak"));
-
-    std::string const specInputStr  = isPower ? "signal"        : "frame";
-    std::string const specOutputStr = isPower ? "powerSpectrum" : "spectrum";
-
-    // std::vector<std::vector<float>> barkBandsVV, BFCCsVV;
-
-    FeatureContainer<vecReal> timbres;
-
-    // Process frame by frame
-    int frameCounter = 0;
+    SpectralFrontEnd frontEnd(frameSize * 2, spectrumOutput(settings));
+    BatchBFCC bfcc(settings);
+    const SpectralDescriptors descriptors(settings, static_cast<size_t>(frameSize) + 1);
+
+    // the spectra, descriptors and BFCC run a block of frames at a time, so only the output grows with the event
+    constexpr size_t blockFrames {64};
+    FeatureMatrix<Real> windowedFrames(static_cast<size_t>(frameSize) * 2), spectra;
+    TimbreFrames timbreBlock(NumTimbralFeatures);
+    windowedFrames.reserveRows(blockFrames);
+    timbreBlock.reserveRows(blockFrames);
+
+    TimbreFrames timbres(NumTimbralFeatures);
+    timbres.reserveRows(waveSpan.size() / static_cast<size_t>(hopSize) + 1);
+
+    vecReal frame, windowedFrame;
+    frameCutter->input("signal").set(wave);
+    frameCutter->output("frame").set(frame);
+    windowing->input("frame").set(frame);
+    windowing->output("frame").set(windowedFrame);
     while (true) {
-        vecReal frame;
-
-        // get next frame
-        frameCutter->input("signal").set(wave);
-        frameCutter->output("frame").set(frame);
         frameCutter->compute();
-
-        // check if done
-        if (frame.empty()) break;
-
-        // apply windowing
-        vecReal windowedFrame;
-        windowing->input("frame").set(frame);
-        windowing->output("frame").set(windowedFrame);
-        windowing->compute();
-
-        // compute spectrum
-        vecReal spectrumVec;
-        spectrum->input(specInputStr).set(windowedFrame);
-        spectrum->output(specOutputStr).set(spectrumVec);
-        spectrum->compute();
-
-        // compute BFCC
-        vecReal _, bfccVec;
-        bfcc->input("spectrum").set(spectrumVec);
-        bfcc->output("bands").set(_);
-        bfcc->output("bfcc").set(bfccVec);
-        bfcc->compute();
-        pushBFCCFrame(timbres, bfccVec);
-
-        Real centroid;
-        centroid_a->input("array").set(spectrumVec);
-        centroid_a->output("centroid").set(centroid);
-        centroid_a->compute();
-        timbres[Feature_e::SpectralCentroid].push_back(centroid);
-
-        Real decrease;
-        decrease_a->input("array").set(spectrumVec);
-        decrease_a->output("decrease").set(decrease);
-        decrease_a->compute();
-        timbres[Feature_e::SpectralDecrease].push_back(decrease);
-
-        Real flatness;
-        flatnessDB_a->input("array").set(spectrumVec);
-        flatnessDB_a->output("flatnessDB").set(flatness);
-        flatnessDB_a->compute();
-        timbres[Feature_e::SpectralFlatness].push_back(flatness);
-
-        Real crest;
-        crest_a->input("array").set(spectrumVec);
-        crest_a->output("crest").set(crest);
-        crest_a->compute();
-        timbres[Feature_e::SpectralCrest].push_back(crest);
-
-        Real spectralComplexity;
-        spectralComplexity_a->input("spectrum").set(spectrumVec);
-        spectralComplexity_a->output("spectralComplexity").set(spectralComplexity);
-        timbres[Feature_e::SpectralComplexity].push_back(spectralComplexity);
-
-        frameCounter++;
+        const bool done = frame.empty();
+        if (!done) {
+            windowing->compute();
+            windowedFrames.appendRow(windowedFrame);
+        }
+        if (done || windowedFrames.numRows() == blockFrames) {
+            frontEnd.compute(windowedFrames, spectra);
+            timbreBlock.clearRows();
+            for (size_t i = 0; i < spectra.numRows(); ++i) {
+                descriptors.compute(spectra.rowSpan(i), timbreBlock.appendRow());
+            }
+            bfcc.compute(spectra, timbreBlock);
+            for (size_t i = 0; i < timbreBlock.numRows(); ++i) {
+                timbres.appendRow(timbreBlock.rowSpan(i));
+            }
+            windowedFrames.clearRows();
+            if (done) {
+                break;
+            }
+        }
     }
 
-    assert(!timbres.bfccs().empty());
-    assert(!timbres.bfccs()[0].empty());
-    const size_t expected_len = timbres.features[0].size();
-    assert(std::ranges::all_of(
-        timbres.features.begin(),
-        timbres.features.begin() + NumTimbralFeatures,
-        [expected_len](const auto &v)
-    {
-        return (v.size() == expected_len);
-    }));
+    assert(!timbres.empty());
+    assert(timbres.numColumns() == NumTimbralFeatures);
 
     return timbres;
 }
 
-vecVecReal PCA(vecVecReal const &V, int num_features_out){
+vecVecReal PCA(FeatureMatrix<Real> const &V, int num_features_out){
     const std::string namespaceIn {"data"};
     const std::string namespaceOut {"pca"};
 
-    standard::Algorithm* PCA = nvs::analysis::standardFactory::create("PCA",
+    const auto PCA = std::unique_ptr<standard::Algorithm>(nvs::analysis::standardFactory::create("PCA",
                                                                       "dimensions", num_features_out,
                                                                       "namespaceIn", namespaceIn,
-                                                                      "namespaceOut", namespaceOut);
+                                                                      "namespaceOut", namespaceOut));
 
+    // the Pool copies each row it is given, so one row buffer is reused for all of them
     Pool inPool, outPool;
-    for (auto v : V){
-        inPool.add(namespaceIn, v);
+    vecReal row(V.numColumns());
+    for (size_t i = 0; i < V.numRows(); ++i){
+        const auto r = V.rowSpan(i);
+        std::copy(r.begin(), r.end(), row.begin());
+        inPool.add(namespaceIn, row);
     }
 
     PCA->input("poolIn").set(inPool);
@@ -25,9 +25,12 @@ PitchesAndConfidences calculatePitchesAndConfidences(vecReal waveEvent, Analyzer
 
 vecReal calculateLoudnesses(std::span<Real const> waveSpan, AnalyzerSettings const& settings);
 
-FeatureContainer<vecReal> calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings);
+// one row per frame, one column per timbral feature (bfcc0 .. StrongPeak)
+using TimbreFrames = FeatureMatrix<Real>;
+TimbreFrames calculateTimbres(std::span<Real const> waveSpan, AnalyzerSettings const& settings);
 
-vecVecReal PCA(vecVecReal const &V, int num_features_out);
+// rows are observations (events), columns are features
+vecVecReal PCA(FeatureMatrix<Real> const &V, int num_features_out);
 
 std::pair<Real, Real> calculateRangeOfDimension(vecReal const &V);  // single-dimensional input
 std::pair<Real, Real> calculateRangeOfDimension(vecVecReal const &V, size_t dim);   // eventwise input
@@ -0,0 +1,117 @@
+//
+// Created by Nicholas Solem on 10/16/26.
+//
+
+// calculateOnsetsMatrixInChunks against calculateOnsetsMatrix on the files given on the command line (the ctest target
+// passes audio/noise_bursts.wav and audio/sweep.wav), with Essentia's detection functions and with the fused kernel:
+// every detection function must agree to within a small fraction of its peak, and the onsets picked from both
+// matrices must be the same to within half a frame. Returns non-zero if any check fails.
+
+#include <iostream>
+#include <juce_core/juce_core.h>
+
+#include "Analyzer.h"
+#include "AnalysisScheduler.h"
+#include "AudioFileInput.h"
+#include "OnsetAnalysis/OnsetAnalysis.h"
+#include "Settings.h"
+#include "StringAxiom.h"
+
+namespace {
+
+using namespace nvs::analysis;
+
+constexpr Real matrixTolerance {1e-4f};    // relative to each detection function's peak
+
+bool matricesAgree(array2dReal const &serial, array2dReal const &chunked) {
+    if (serial.dim1() != chunked.dim1() || serial.dim2() != chunked.dim2()) {
+        std::cerr << "\tmatrix sizes differ: " << serial.dim1() << "x" << serial.dim2() << " vs. "
+                  << chunked.dim1() << "x" << chunked.dim2() << "\n";
+        return false;
+    }
+    bool agree {true};
+    for (int i = 0; i < serial.dim1(); ++i) {
+        Real peak {0.f}, maxDiff {0.f};
+        for (int j = 0; j < serial.dim2(); ++j) {
+            peak = std::max(peak, std::abs(serial[i][j]));
+            maxDiff = std::max(maxDiff, std::abs(serial[i][j] - chunked[i][j]));
+        }
+        if (const Real relativeDiff = peak > 0.f ? maxDiff / peak : maxDiff;
+            relativeDiff > matrixTolerance)
+        {
+            std::cerr << "\tdetection function " << i << " differs by " << relativeDiff << " of its peak\n";
+            agree = false;
+        }
+    }
+    return agree;
+}
+
+bool onsetsAgree(vecReal const &serial, vecReal const &chunked, const Real toleranceSeconds) {
+    if (serial.size() != chunked.size()) {
+        std::cerr << "\t" << serial.size() << " serial onsets vs. " << chunked.size() << " chunked\n";
+        return false;
+    }
+    for (size_t i = 0; i < serial.size(); ++i) {
+        if (std::abs(serial[i] - chunked[i]) > toleranceSeconds) {
+            std::cerr << "\tonset " << i << ": " << serial[i] << " s vs. " << chunked[i] << " s\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testFile(juce::File const &file, const bool fusedDetection) {
+    vecReal wave;
+    const auto info = readIntoWave(wave, file);
+    if (info.numSamples == 0) {
+        std::cerr << "could not read " << file.getFullPathName() << "\n";
+        return false;
+    }
+
+    AnalyzerSettings settings;
+    settings.analysis.sampleRate = info.sampleRate;
+    settings.info.sampleFilePath = file.getFullPathName();
+    settings.onset.fusedDetection = fusedDetection;
+    auto settingsTree = createParentTreeFromSettings(settings).getChildWithName(nvs::axiom::tsn::Settings);
+    Analyzer analyzer;
+    if (!analyzer.updateSettings(settingsTree, true)) {
+        std::cerr << "invalid settings for " << file.getFileName() << "\n";
+        return false;
+    }
+
+    RunLoopStatus rls;
+    const ShouldExitFn neverExit = [] { return false; };
+    auto const &analyzerSettings = analyzer.getSettings();
+    const auto serial = calculateOnsetsMatrix(wave, analyzer.ess_hold.factory, analyzerSettings, rls, neverExit);
+    AnalysisScheduler scheduler(4);
+    const auto chunked = calculateOnsetsMatrixInChunks(wave, analyzer.ess_hold.factory, analyzerSettings, scheduler,
+                                                       rls, neverExit);
+
+    const auto &standardFac = essentia::standard::AlgorithmFactory::instance();
+    const Real halfFrameSeconds = 0.5f / getOnsetFrameGeometry(analyzerSettings).frameRate();
+    const bool matrixOk = matricesAgree(serial, chunked);
+    const bool onsetsOk = matrixOk
+        && onsetsAgree(calculateOnsetsInSeconds(serial, standardFac, analyzerSettings),
+                       calculateOnsetsInSeconds(chunked, standardFac, analyzerSettings), halfFrameSeconds);
+
+    std::cout << (matrixOk && onsetsOk ? "PASS " : "FAIL ") << file.getFileName()
+              << (fusedDetection ? " (fused)" : " (Essentia)") << ": " << serial.dim2() << " frames\n";
+    return matrixOk && onsetsOk;
+}
+
+}   // anonymous namespace
+
+int main(const int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: onset_chunks_test <audio_file>...\n";
+        return 2;
+    }
+    bool allPassed {true};
+    for (int i = 1; i < argc; ++i) {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(argv[i]);
+        for (const bool fused : {false, true}) {
+            allPassed = testFile(file, fused) && allPassed;
+        }
+    }
+    return allPassed ? 0 : 1;
+}